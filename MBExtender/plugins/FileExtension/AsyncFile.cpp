@@ -0,0 +1,505 @@
+//-----------------------------------------------------------------------------
+// AsyncFile.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// Asynchronous file operations. Reading, writing, copying, deleting and
+// listing run on a small pool of worker threads, and the result is passed to
+// a script callback on the main thread once the operation is done:
+//
+//    function onFileRead(%id, %success, %result) { ... }
+//    %id = asyncReadFile("platinum/data/replay.rrec", "onFileRead");
+//
+// %result is the file contents for reads, a tab-separated list of names for
+// directory listings (directories end with a slash), the hex digest for
+// hashes, and an error message when %success is false. Cancelled operations don't call their callback.
+//
+// Script strings can't hold zero bytes, so plain reads fail on binary files.
+// Read those as hex or base64 instead:
+//
+//    %id = asyncReadFile("platinum/data/replay.rrec", "onFileRead", "base64");
+
+#include <MBExtender/MBExtender.h>
+#include <MathLib/MathLib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "FileExtension.h"
+#include "codec.h"
+#include "hash.h"
+
+#include <TorqueLib/console/console.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define strcasecmp _stricmp
+#else
+#include <dirent.h>
+#include <strings.h>
+#endif
+
+MBX_MODULE(AsyncFile);
+
+#define ASYNC_FILE_BLOCK_SIZE (64 * 1024)
+#define ASYNC_FILE_DEFAULT_CONCURRENCY 2
+#define ASYNC_FILE_MAX_CONCURRENCY 16
+
+enum AsyncFileOp {
+	AsyncRead,
+	AsyncWrite,
+	AsyncCopy,
+	AsyncDelete,
+	AsyncList,
+	AsyncHash
+};
+
+enum AsyncFileEncoding {
+	AsyncText,
+	AsyncHex,
+	AsyncBase64
+};
+
+struct AsyncFileJob {
+	U32 id;
+	AsyncFileOp op;
+	//Expanded paths, target is only used for copies
+	std::string path;
+	std::string target;
+	//Data to write, or the result of the operation once it is done
+	std::string data;
+	std::string callback;
+	//Only used for hashing
+	Hash::Hasher *hasher;
+	//Only used for reads
+	AsyncFileEncoding encoding;
+	bool append;
+	bool success;
+	std::atomic<bool> cancelled;
+
+	~AsyncFileJob() {
+		delete hasher;
+	}
+};
+
+static std::mutex gAsyncMutex;
+static std::condition_variable gAsyncWake;
+//All of these are protected by gAsyncMutex
+static std::deque<AsyncFileJob *> gPendingJobs;
+static std::vector<AsyncFileJob *> gFinishedJobs;
+static std::unordered_map<U32, AsyncFileJob *> gJobs;
+static U32 gMaxConcurrent = ASYNC_FILE_DEFAULT_CONCURRENCY;
+static bool gShutdown = false;
+
+//Only touched on the main thread
+static std::vector<std::thread> gWorkers;
+static U32 gNextJobId = 1;
+
+//------------------------------------------------------------------------------
+// Worker side
+//------------------------------------------------------------------------------
+
+static bool fail(AsyncFileJob *job, int error) {
+	job->data = strerror(error);
+	return false;
+}
+
+/**
+ * Convert the data read from a file into something that can be passed to
+ * script, which sees the result as a C string.
+ * @arg job The read job, its data is replaced with the encoded contents.
+ * @return False if the file is binary and was read as text.
+ */
+static bool encodeData(AsyncFileJob *job) {
+	const U8 *bytes = reinterpret_cast<const U8 *>(job->data.data());
+	std::string encoded;
+	switch (job->encoding) {
+		case AsyncText:
+			if (memchr(job->data.data(), 0, job->data.size()) != NULL) {
+				job->data = "File contains binary data, read it as hex or base64";
+				return false;
+			}
+			return true;
+		case AsyncHex:
+			encoded.resize(Codec::hexEncodedLength(job->data.size()));
+			Codec::hexEncode(&encoded[0], bytes, job->data.size());
+			break;
+		case AsyncBase64:
+			encoded.resize(Codec::base64EncodedLength(job->data.size()));
+			Codec::base64Encode(&encoded[0], bytes, job->data.size());
+			break;
+	}
+	job->data.swap(encoded);
+	return true;
+}
+
+static bool readFile(AsyncFileJob *job) {
+	FILE *file = fopen(job->path.c_str(), "rb");
+	if (file == NULL)
+		return fail(job, errno);
+
+	char buffer[ASYNC_FILE_BLOCK_SIZE];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		if (job->cancelled.load())
+			break;
+		job->data.append(buffer, read);
+	}
+	bool error = (ferror(file) != 0);
+	fclose(file);
+
+	if (error) {
+		job->data.clear();
+		return fail(job, EIO);
+	}
+	return encodeData(job);
+}
+
+static bool writeFile(AsyncFileJob *job) {
+	FILE *file = fopen(job->path.c_str(), job->append ? "ab" : "wb");
+	if (file == NULL)
+		return fail(job, errno);
+
+	size_t written = 0;
+	while (written < job->data.size() && !job->cancelled.load()) {
+		size_t block = job->data.size() - written;
+		if (block > ASYNC_FILE_BLOCK_SIZE)
+			block = ASYNC_FILE_BLOCK_SIZE;
+		if (fwrite(job->data.data() + written, 1, block, file) != block)
+			break;
+		written += block;
+	}
+	bool error = (written != job->data.size());
+	if (fclose(file) != 0)
+		error = true;
+
+	//Don't leave a half-written file behind
+	if (error && !job->append)
+		remove(job->path.c_str());
+
+	job->data.clear();
+	return error ? fail(job, job->cancelled.load() ? ECANCELED : EIO) : true;
+}
+
+static bool listDirectory(AsyncFileJob *job) {
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE find = FindFirstFileA((job->path + "/*").c_str(), &entry);
+	if (find == INVALID_HANDLE_VALUE)
+		return fail(job, ENOENT);
+
+	do {
+		if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0)
+			continue;
+		if (!job->data.empty())
+			job->data += '\t';
+		job->data += entry.cFileName;
+		if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			job->data += '/';
+	} while (!job->cancelled.load() && FindNextFileA(find, &entry));
+	FindClose(find);
+#else
+	DIR *dir = opendir(job->path.c_str());
+	if (dir == NULL)
+		return fail(job, errno);
+
+	struct dirent *entry;
+	while (!job->cancelled.load() && (entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		if (!job->data.empty())
+			job->data += '\t';
+		job->data += entry->d_name;
+
+		struct stat st;
+		std::string full = job->path + "/" + entry->d_name;
+		if (stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+			job->data += '/';
+	}
+	closedir(dir);
+#endif
+	return true;
+}
+
+static void runJob(AsyncFileJob *job) {
+	if (job->cancelled.load())
+		return;
+
+	switch (job->op) {
+		case AsyncRead:
+			job->success = readFile(job);
+			break;
+		case AsyncWrite:
+			job->success = writeFile(job);
+			break;
+		case AsyncCopy:
+			job->success = (cp(job->target.c_str(), job->path.c_str(), &job->cancelled) == 0 || fail(job, errno));
+			break;
+		case AsyncDelete:
+			job->success = (remove(job->path.c_str()) == 0 || fail(job, errno));
+			break;
+		case AsyncList:
+			job->success = listDirectory(job);
+			break;
+		case AsyncHash:
+			job->success = Hash::hashFile(job->hasher, job->path.c_str(), &job->cancelled);
+			if (job->success) {
+				char digest[Hash::MaxDigestLength * 2 + 1];
+				Hash::finishHex(job->hasher, digest);
+				job->data = digest;
+			} else {
+				fail(job, job->cancelled.load() ? ECANCELED : EIO);
+			}
+			break;
+	}
+}
+
+static void workerMain(U32 index) {
+	std::unique_lock<std::mutex> lock(gAsyncMutex);
+	while (true) {
+		//Workers past the concurrency cap sit idle until it is raised again
+		while (!gShutdown && (gPendingJobs.empty() || index >= gMaxConcurrent))
+			gAsyncWake.wait(lock);
+		if (gShutdown)
+			return;
+
+		AsyncFileJob *job = gPendingJobs.front();
+		gPendingJobs.pop_front();
+
+		lock.unlock();
+		runJob(job);
+		lock.lock();
+
+		gFinishedJobs.push_back(job);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Main thread side
+//------------------------------------------------------------------------------
+
+static AsyncFileJob *createJob(AsyncFileOp op, const char *path, const char *callback) {
+	AsyncFileJob *job = new AsyncFileJob;
+	job->id = gNextJobId++;
+	job->op = op;
+
+	char expanded[256];
+	TGE::Con::expandScriptFilename(expanded, 256, path);
+	job->path = expanded;
+
+	job->callback = callback;
+	job->hasher = NULL;
+	job->encoding = AsyncText;
+	job->append = false;
+	job->success = false;
+	job->cancelled = false;
+	return job;
+}
+
+/**
+ * Start enough workers to run as many jobs as the concurrency cap allows.
+ * Threads are only started once there is work for them, and stay around
+ * until the game exits.
+ */
+static void startWorkers() {
+	size_t wanted;
+	{
+		std::lock_guard<std::mutex> lock(gAsyncMutex);
+		wanted = (gJobs.size() < gMaxConcurrent ? gJobs.size() : gMaxConcurrent);
+	}
+	while (gWorkers.size() < wanted) {
+		gWorkers.push_back(std::thread(workerMain, static_cast<U32>(gWorkers.size())));
+	}
+	gAsyncWake.notify_all();
+}
+
+static U32 queueJob(AsyncFileJob *job) {
+	U32 id = job->id;
+	{
+		std::lock_guard<std::mutex> lock(gAsyncMutex);
+		gPendingJobs.push_back(job);
+		gJobs[id] = job;
+	}
+	startWorkers();
+	return id;
+}
+
+MBX_ON_CLIENT_PROCESS(asyncFileProcess, (uint32_t deltaMs)) {
+	std::vector<AsyncFileJob *> finished;
+	{
+		std::lock_guard<std::mutex> lock(gAsyncMutex);
+		if (gFinishedJobs.empty())
+			return;
+		finished.swap(gFinishedJobs);
+		for (U32 i = 0; i < finished.size(); i++) {
+			gJobs.erase(finished[i]->id);
+		}
+	}
+
+	for (U32 i = 0; i < finished.size(); i++) {
+		AsyncFileJob *job = finished[i];
+		if (!job->cancelled.load()) {
+			//The resource manager isn't thread safe, so it's updated here
+			if (job->success && job->op == AsyncCopy)
+				addCopiedResource(job->path.c_str(), job->target.c_str());
+			if (job->success && job->op == AsyncDelete)
+				removeResource(job->path.c_str());
+
+			if (!job->callback.empty()) {
+				char id[16];
+				snprintf(id, sizeof(id), "%u", job->id);
+				TGE::Con::executef(4, job->callback.c_str(), id, job->success ? "1" : "0", job->data.c_str());
+			}
+		}
+		delete job;
+	}
+}
+
+MBX_ON_GAME_EXIT(asyncFileShutdown, ()) {
+	{
+		std::lock_guard<std::mutex> lock(gAsyncMutex);
+		gShutdown = true;
+		for (std::unordered_map<U32, AsyncFileJob *>::iterator it = gJobs.begin(); it != gJobs.end(); it++) {
+			it->second->cancelled = true;
+		}
+	}
+	gAsyncWake.notify_all();
+
+	//Running jobs stop at their next block
+	for (U32 i = 0; i < gWorkers.size(); i++) {
+		gWorkers[i].join();
+	}
+	gWorkers.clear();
+
+	for (std::unordered_map<U32, AsyncFileJob *>::iterator it = gJobs.begin(); it != gJobs.end(); it++) {
+		delete it->second;
+	}
+	gJobs.clear();
+	gPendingJobs.clear();
+	gFinishedJobs.clear();
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(asyncReadFile, S32, 3, 4, "asyncReadFile(path, callback[, encoding]) - Read a file in the background as text, hex or base64. Text reads fail on binary files. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+
+	AsyncFileEncoding encoding = AsyncText;
+	if (argc > 3) {
+		if (strcasecmp(argv[3], "hex") == 0) {
+			encoding = AsyncHex;
+		} else if (strcasecmp(argv[3], "base64") == 0) {
+			encoding = AsyncBase64;
+		} else if (strcasecmp(argv[3], "text") != 0) {
+			TGE::Con::errorf("asyncReadFile: Unknown encoding %s", argv[3]);
+			return 0;
+		}
+	}
+
+	AsyncFileJob *job = createJob(AsyncRead, argv[1], argv[2]);
+	job->encoding = encoding;
+	return queueJob(job);
+}
+
+MBX_CONSOLE_FUNCTION(asyncWriteFile, S32, 4, 5, "asyncWriteFile(path, data, callback[, append]) - Write a file in the background. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+	AsyncFileJob *job = createJob(AsyncWrite, argv[1], argv[3]);
+	job->data = argv[2];
+	job->append = (argc > 4 && StringMath::scan<bool>(argv[4]));
+	return queueJob(job);
+}
+
+MBX_CONSOLE_FUNCTION(asyncCopyFile, S32, 4, 4, "asyncCopyFile(from, to, callback) - Copy a file in the background. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]) || !pathCheck(argv[2]))
+		return 0;
+	AsyncFileJob *job = createJob(AsyncCopy, argv[1], argv[3]);
+
+	char to[256];
+	TGE::Con::expandScriptFilename(to, 256, argv[2]);
+	job->target = to;
+	return queueJob(job);
+}
+
+MBX_CONSOLE_FUNCTION(asyncDeleteFile, S32, 3, 3, "asyncDeleteFile(path, callback) - Delete a file in the background. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+	return queueJob(createJob(AsyncDelete, argv[1], argv[2]));
+}
+
+MBX_CONSOLE_FUNCTION(asyncListDirectory, S32, 3, 3, "asyncListDirectory(path, callback) - List a directory in the background. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+	return queueJob(createJob(AsyncList, argv[1], argv[2]));
+}
+
+MBX_CONSOLE_FUNCTION(asyncHashFile, S32, 4, 4, "asyncHashFile(algorithm, path, callback) - Hash a file in the background with crc32, xxh64 or sha256. Returns an operation id, or 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[2]))
+		return 0;
+	Hash::Hasher *hasher = createHasher("asyncHashFile", argv[1]);
+	if (hasher == NULL)
+		return 0;
+	AsyncFileJob *job = createJob(AsyncHash, argv[2], argv[3]);
+	job->hasher = hasher;
+	return queueJob(job);
+}
+
+MBX_CONSOLE_FUNCTION(asyncFileCancel, bool, 2, 2, "asyncFileCancel(id) - Cancel an operation. Its callback won't be called.") {
+	U32 id = StringMath::scan<U32>(argv[1]);
+	std::lock_guard<std::mutex> lock(gAsyncMutex);
+	std::unordered_map<U32, AsyncFileJob *>::iterator it = gJobs.find(id);
+	if (it == gJobs.end())
+		return false;
+	it->second->cancelled = true;
+	return true;
+}
+
+MBX_CONSOLE_FUNCTION(asyncFileSetMaxConcurrent, void, 2, 2, "asyncFileSetMaxConcurrent(count) - Set how many operations can run at the same time") {
+	U32 count = mClamp(StringMath::scan<S32>(argv[1]), 1, ASYNC_FILE_MAX_CONCURRENCY);
+	{
+		std::lock_guard<std::mutex> lock(gAsyncMutex);
+		gMaxConcurrent = count;
+	}
+	startWorkers();
+}
+
+MBX_CONSOLE_FUNCTION(asyncFileGetPending, S32, 1, 1, "asyncFileGetPending() - Get the number of operations that haven't finished") {
+	std::lock_guard<std::mutex> lock(gAsyncMutex);
+	return gJobs.size();
+}
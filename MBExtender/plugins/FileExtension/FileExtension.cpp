@@ -28,6 +28,8 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include "codec.h"
+#include "FileExtension.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -77,8 +79,13 @@ MBX_MODULE(FileExtension);
 
 bool initPlugin(MBX::Plugin &plugin)
 {
+	Codec::init(plugin.getCpuFeatures());
+	MBX_INSTALL(plugin, AsyncFile);
 	MBX_INSTALL(plugin, FileExtension);
 	MBX_INSTALL(plugin, FileObjectExtension);
+	MBX_INSTALL(plugin, Hashing);
+	MBX_INSTALL(plugin, LineReader);
+	MBX_INSTALL(plugin, MappedFile);
 	return true;
 }
 
@@ -108,12 +115,7 @@ static const char* nextPathComponent(const char *path)
 	return path + 1; // Skip the slash after the component
 }
 
-/**
- * Check if the game should be allowed to access a path.
- * @arg path The path to check
- * @return Whether the path can be accessed
- */
-static bool pathCheck(const char *path) {
+bool pathCheck(const char *path) {
 	// Disallow absolute paths
 	if (path[0] == '/')
 		return false;
@@ -147,7 +149,47 @@ static bool pathCheck(const char *path) {
 //------------------------------------------------------------------------------
 // Misc utilities
 //------------------------------------------------------------------------------
-int cp(const char *to, const char *from);
+/**
+ * Copy a resource's entry after its file has been copied, so the resource
+ * manager can find the new file.
+ * @arg from The expanded path of the source file.
+ * @arg to The expanded path of the new file.
+ */
+void addCopiedResource(const char *from, const char *to) {
+	TGE::ResourceObject *res = TGE::ResourceManager->find(from);
+	if (!res) {
+		return;
+	}
+
+	std::string toStr(to);
+	int lastSlash = toStr.find_last_of('/');
+
+	const char *path;
+	const char *file;
+
+	if (lastSlash == std::string::npos) {
+		path = TGE::StringTable->insert("", false);
+		file = TGE::StringTable->insert(to, false);
+	} else {
+		path = TGE::StringTable->insert(toStr.substr(0, lastSlash).c_str(), false);
+		file = TGE::StringTable->insert(toStr.substr(lastSlash + 1).c_str(), false);
+	}
+
+	TGE::ResourceObject *ro = TGE::ResourceManager->createResource(path, file);
+	ro->flags = res->flags;
+	ro->fileOffset = res->fileOffset;
+	ro->fileSize = res->fileSize;
+	ro->compressedFileSize = res->compressedFileSize;
+}
+
+/**
+ * Remove a deleted file from the resource manager.
+ * @arg path The expanded path of the deleted file.
+ */
+void removeResource(const char *path) {
+	TGE::ResourceObject *res = TGE::ResourceManager->find(path);
+	TGE::ResourceManager->freeResource(res);
+}
 
 /**
  * Get a file's size from script.
@@ -199,8 +241,7 @@ MBX_CONSOLE_FUNCTION(deleteFile, bool, 2, 2, "deleteFile(file) - Delete a file f
 	}
 
 	//Delete from the FS
-	TGE::ResourceObject *res = TGE::ResourceManager->find(path);
-	TGE::ResourceManager->freeResource(res);
+	removeResource(path);
 
 	return true;
 }
@@ -280,31 +321,8 @@ MBX_CONSOLE_FUNCTION(copyFile, bool, 3, 3, "copyFile(from, to) - Create a copy o
 		return false;
 	}
 
-	//Tell the FS we've moved it
-	TGE::ResourceObject *res = TGE::ResourceManager->find(from);
-	if (!res) {
-		return true;
-	}
-
-	std::string toStr(to);
-	int lastSlash = toStr.find_last_of('/');
-
-	const char *path;
-	const char *file;
-
-	if (lastSlash == std::string::npos) {
-		path = TGE::StringTable->insert("", false);
-		file = TGE::StringTable->insert(to, false);
-	} else {
-		path = TGE::StringTable->insert(toStr.substr(0, lastSlash).c_str(), false);
-		file = TGE::StringTable->insert(toStr.substr(lastSlash + 1).c_str(), false);
-	}
-
-	TGE::ResourceObject *ro = TGE::ResourceManager->createResource(path, file);
-	ro->flags = res->flags;
-	ro->fileOffset = res->fileOffset;
-	ro->fileSize = res->fileSize;
-	ro->compressedFileSize = res->compressedFileSize;
+	//Tell the FS we've copied it
+	addCopiedResource(from, to);
 
 	return true;
 }
@@ -392,10 +410,12 @@ MBX_CONSOLE_FUNCTION(createSymlink, bool, 3, 3, "createSymlink(from, to) - Creat
  * Copies a file from one location to another.
  * @arg to The destination file
  * @arg from The source file
+ * @arg cancel If not NULL, checked between blocks. The copy stops and the
+ *             partial destination is deleted once it becomes true.
  * @return Zero if success, non-zero if error.
  */
 //Shameless copy from http://stackoverflow.com/a/2180788/214063
-int cp(const char *to, const char *from)
+int cp(const char *to, const char *from, const std::atomic<bool> *cancel)
 {
 	int fd_to, fd_from;
 	char buf[4096];
@@ -412,6 +432,15 @@ int cp(const char *to, const char *from)
 
 	while (nread = read(fd_from, buf, sizeof buf), nread > 0)
 	{
+		if (cancel != NULL && cancel->load())
+		{
+			close(fd_to);
+			fd_to = -1;
+			remove(to);
+			errno = ECANCELED;
+			goto out_error;
+		}
+
 		char *out_ptr = buf;
 		ssize_t nwritten;
 
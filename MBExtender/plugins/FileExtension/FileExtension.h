@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// FileExtension.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+/**
+ * Check if the game should be allowed to access a path.
+ * @arg path The path to check
+ * @return Whether the path can be accessed
+ */
+bool pathCheck(const char *path);
+
+/**
+ * Copies a file from one location to another. Fails if the destination
+ * already exists.
+ * @arg to The destination file
+ * @arg from The source file
+ * @arg cancel Optional flag which stops the copy when set
+ * @return Zero if success, non-zero if error.
+ */
+int cp(const char *to, const char *from, const std::atomic<bool> *cancel = NULL);
+
+/**
+ * Let the resource manager know about a copied file.
+ * @arg from The expanded path of the source file
+ * @arg to The expanded path of the new file
+ */
+void addCopiedResource(const char *from, const char *to);
+
+/**
+ * Let the resource manager know a file was deleted.
+ * @arg path The expanded path of the deleted file
+ */
+void removeResource(const char *path);
+
+namespace Hash {
+	class Hasher;
+}
+
+/**
+ * Create a hasher from an algorithm name given by script, logging an error
+ * if the name is unknown.
+ * @arg function The console function to blame in the error
+ * @arg name The algorithm name
+ * @return The new hasher, or NULL on failure
+ */
+Hash::Hasher *createHasher(const char *function, const char *name);
@@ -23,7 +23,8 @@
 #include <MBExtender/MBExtender.h>
 #include <string.h>
 #include <MathLib/MathLib.h>
-#include "base64.h"
+#include <vector>
+#include "codec.h"
 
 #include <TorqueLib/console/console.h>
 #include <TorqueLib/core/fileObject.h>
@@ -38,97 +39,92 @@ MBX_CONSOLE_METHOD(FileObject, readRaw, const char *, 2, 3, "FileObject.readRaw(
 	if(!object->getFileBuffer())
 		return "";
 
-	//Torque just caches all of this in ram. Bad Torque!
+	//Torque just caches all of this in ram, so encode straight out of its buffer
 	U32 readSize = (argc > 2 ? atoi(argv[2]) : 512);
-
-	U8 *data = new U8[readSize];
-	object->_read(readSize, &data, &readSize);
-
-	//Don't forget the 1 byte terminator
-	char *text = TGE::Con::getReturnBuffer((readSize * 2) + 1);
-
-	//Sprintf all the things... Sadly
-	for (U32 i = 0; i < readSize; i ++) {
-		sprintf(text + (i * 2), "%02X", data[i]);
+	U32 position = object->getCurPos();
+	if (readSize > object->getBufferSize() - position) {
+		readSize = object->getBufferSize() - position;
 	}
 
-	//Because I'm suspicious
-	text[readSize * 2] = 0;
+	//Don't forget the 1 byte terminator
+	char *text = TGE::Con::getReturnBuffer(Codec::hexEncodedLength(readSize) + 1);
+	Codec::hexEncode(text, object->getFileBuffer() + position, readSize);
+	text[Codec::hexEncodedLength(readSize)] = 0;
 
+	object->setCurPos(position + readSize);
 	return text;
 }
 
-MBX_CONSOLE_METHOD(FileObject, writeRaw, bool, 3, 3, "FileObject.writeRaw(raw data) -> Write raw bytes to a file.\n"
+MBX_CONSOLE_METHOD(FileObject, writeRaw, bool, 3, 4, "FileObject.writeRaw(raw data[, strict = true]) -> Write raw bytes to a file.\n"
 			       "The raw data bytes should be 2-char hex byte strings (so like 000102030F7F etc.)") {
 	const char *text = argv[2];
+	bool strict = (argc > 3 ? StringMath::scan<bool>(argv[3]) : true);
 
 	//Make sure this is correctly formatted
 	U32 length = strlen(text);
-	if (length % 2 != 0) {
+	if (strict && length % 2 != 0) {
 		TGE::Con::errorf("FileObject::writeRaw(): Data is not a multiple of 2 bytes");
 		return false;
 	}
-	length /= 2;
 
-	//Buffer for our data
-	U8 *data = new U8[length];
-
-	//Read bytes from the text as 2-char hex strings
-	for (U32 i = 0; i < length; i ++) {
-		U32 value;
-		sscanf(text + (i * 2), "%02X", &value);
-		//Put them into data
-		data[i] = static_cast<U8>(value);
+	std::vector<U8> data(Codec::hexDecodedMaxLength(length));
+	size_t decodedLength = 0;
+	if (!Codec::hexDecode(data.data(), &decodedLength, text, length, strict)) {
+		TGE::Con::errorf("FileObject::writeRaw(): Data is not a valid hex string");
+		return false;
 	}
 
 	//Write it out
-	bool ret = object->_write(length, data);
-	//Clean up
-	delete [] data;
-	return ret;
+	return object->_write(decodedLength, data.data());
 }
 
 MBX_CONSOLE_METHOD(FileObject, readBase64, const char *, 2, 3, "FileObject.readBase64([length = everything]) -> Read base64-encoded bytes from a file") {
-	S32 length;
+	if (!object->getFileBuffer())
+		return "";
+
+	U32 remaining = object->getBufferSize() - object->getCurPos();
+	U32 length = remaining;
 	if (argc == 3) {
-		length = StringMath::scan<S32>(argv[2]);
-		if (length + object->getBufferSize() > object->getCurPos()) {
-			length = object->getBufferSize() - object->getCurPos();
+		length = StringMath::scan<U32>(argv[2]);
+		if (length > remaining) {
+			length = remaining;
 		}
-	} else {
-		length = object->getBufferSize() - object->getCurPos();
 	}
 
-	std::string ret;
-	base64_encode(ret, object->getFileBuffer() + object->getCurPos(), length);
-
-	char *buffer = TGE::Con::getReturnBuffer(ret.size() + 1);
-	memcpy(buffer, ret.data(), ret.size());
-	buffer[ret.size()] = 0;
+	size_t encodedLength = Codec::base64EncodedLength(length);
+	char *buffer = TGE::Con::getReturnBuffer(encodedLength + 1);
+	Codec::base64Encode(buffer, object->getFileBuffer() + object->getCurPos(), length);
+	buffer[encodedLength] = 0;
 	return buffer;
 }
 
-MBX_CONSOLE_METHOD(FileObject, writeBase64, bool, 3, 3, "FileObject.writeBase64(base64 data) -> Write base64-encoded bytes to a file") {
+MBX_CONSOLE_METHOD(FileObject, writeBase64, bool, 3, 4, "FileObject.writeBase64(base64 data[, strict = false]) -> Write base64-encoded bytes to a file") {
 	const char *text = argv[2];
+	bool strict = (argc > 3 ? StringMath::scan<bool>(argv[3]) : false);
 
-	std::vector<uint8_t> bytes;
-	base64_decode(bytes, text);
+	U32 length = strlen(text);
+	std::vector<U8> bytes(Codec::base64DecodedMaxLength(length));
+	size_t decodedLength = 0;
+	if (!Codec::base64Decode(bytes.data(), &decodedLength, text, length, strict)) {
+		TGE::Con::errorf("FileObject::writeBase64(): Data is not valid base64");
+		return false;
+	}
 
 	//Write it out
-	bool ret = object->_write(bytes.size(), bytes.data());
-	return ret;
+	return object->_write(decodedLength, bytes.data());
 }
 
-MBX_CONSOLE_FUNCTION(base64decode, const char *, 2, 2, "base64decode(base64 data)") {
+MBX_CONSOLE_FUNCTION(base64decode, const char *, 2, 3, "base64decode(base64 data[, strict = false])") {
 	const char *text = argv[1];
+	bool strict = (argc > 2 ? StringMath::scan<bool>(argv[2]) : false);
 
-
-	std::vector<uint8_t> bytes;
-	base64_decode(bytes, text);
-
-	char *buffer = TGE::Con::getReturnBuffer(bytes.size() + 1);
-	memcpy(buffer, bytes.data(), bytes.size());
-	buffer[bytes.size()] = 0;
+	U32 length = strlen(text);
+	char *buffer = TGE::Con::getReturnBuffer(Codec::base64DecodedMaxLength(length) + 1);
+	size_t decodedLength = 0;
+	if (!Codec::base64Decode(reinterpret_cast<U8 *>(buffer), &decodedLength, text, length, strict)) {
+		return "";
+	}
+	buffer[decodedLength] = 0;
 
 	return buffer;
 }
@@ -136,12 +132,11 @@ MBX_CONSOLE_FUNCTION(base64decode, const char *, 2, 2, "base64decode(base64 data
 MBX_CONSOLE_FUNCTION(base64encode, const char *, 2, 2, "base64encode(string data)") {
 	const char *input = argv[1];
 
-	std::string ret;
-	base64_encode(ret, (const uint8_t *)input, strlen(input));
-
-	char *buffer = TGE::Con::getReturnBuffer(ret.size() + 1);
-	memcpy(buffer, ret.data(), ret.size());
-	buffer[ret.size()] = 0;
+	U32 length = strlen(input);
+	size_t encodedLength = Codec::base64EncodedLength(length);
+	char *buffer = TGE::Con::getReturnBuffer(encodedLength + 1);
+	Codec::base64Encode(buffer, reinterpret_cast<const U8 *>(input), length);
+	buffer[encodedLength] = 0;
 	return buffer;
 }
 
@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// Hashing.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// Native hashing for files and strings. Supported algorithms are "crc32",
+// "xxh64" (fast, for cache keys and change detection) and "sha256" (for
+// integrity checks). Digests are returned as lowercase hex.
+
+#include <MBExtender/MBExtender.h>
+#include <MathLib/MathLib.h>
+#include <string.h>
+#include <unordered_map>
+#include "FileExtension.h"
+#include "hash.h"
+
+#include <TorqueLib/console/console.h>
+#include <TorqueLib/console/simBase.h>
+#include <TorqueLib/console/scriptObject.h>
+
+MBX_MODULE(Hashing);
+
+static const char *formatDigest(Hash::Hasher *hasher) {
+	char *ret = TGE::Con::getReturnBuffer(Hash::MaxDigestLength * 2 + 1);
+	Hash::finishHex(hasher, ret);
+	return ret;
+}
+
+Hash::Hasher *createHasher(const char *function, const char *name) {
+	Hash::Algorithm algorithm;
+	if (!Hash::findAlgorithm(name, algorithm)) {
+		TGE::Con::errorf("%s: Unknown hash algorithm %s", function, name);
+		return NULL;
+	}
+	return Hash::Hasher::create(algorithm);
+}
+
+//------------------------------------------------------------------------------
+// One-shot hashing
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(hashString, const char *, 3, 3, "hashString(algorithm, string) - Hash a string with crc32, xxh64 or sha256") {
+	Hash::Hasher *hasher = createHasher("hashString", argv[1]);
+	if (hasher == NULL)
+		return "";
+
+	hasher->update(reinterpret_cast<const U8 *>(argv[2]), strlen(argv[2]));
+	const char *digest = formatDigest(hasher);
+	delete hasher;
+	return digest;
+}
+
+MBX_CONSOLE_FUNCTION(hashFile, const char *, 3, 3, "hashFile(algorithm, path) - Hash a file with crc32, xxh64 or sha256. Returns \"\" if the file can't be read.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[2]))
+		return "";
+
+	char path[256];
+	TGE::Con::expandScriptFilename(path, 256, argv[2]);
+
+	Hash::Hasher *hasher = createHasher("hashFile", argv[1]);
+	if (hasher == NULL)
+		return "";
+
+	const char *digest = "";
+	if (Hash::hashFile(hasher, path)) {
+		digest = formatDigest(hasher);
+	}
+	delete hasher;
+	return digest;
+}
+
+//------------------------------------------------------------------------------
+// Incremental hashing
+//------------------------------------------------------------------------------
+
+std::unordered_map<SimObjectId, Hash::Hasher *> gHashers;
+
+static Hash::Hasher *resolveHasher(TGE::SimObject *object) {
+	std::unordered_map<SimObjectId, Hash::Hasher *>::iterator it = gHashers.find(object->getId());
+	if (it == gHashers.end())
+		return NULL;
+	return it->second;
+}
+
+MBX_OVERRIDE_MEMBERFN(void, TGE::SimObject::deleteObject, (TGE::SimObject *thisptr), originalDeleteObject) {
+	std::unordered_map<SimObjectId, Hash::Hasher *>::iterator it = gHashers.find(thisptr->getId());
+	if (it != gHashers.end()) {
+		delete it->second;
+		gHashers.erase(it);
+	}
+	originalDeleteObject(thisptr);
+}
+
+MBX_CONSOLE_FUNCTION(Hasher, S32, 2, 2, "Hasher(algorithm) - Create an object for hashing data in pieces. Returns 0 on failure.") {
+	Hash::Hasher *hasher = createHasher("Hasher", argv[1]);
+	if (hasher == NULL)
+		return 0;
+
+	TGE::ScriptObject *object = TGE::ScriptObject::create();
+	object->mClassName = "Hasher";
+	object->mFlags |= TGE::SimObject::ModDynamicFields | TGE::SimObject::ModStaticFields;
+	object->registerObject();
+
+	gHashers[object->getId()] = hasher;
+	return object->getId();
+}
+
+MBX_CONSOLE_METHOD_NAMED(Hasher, update, void, 3, 3, "(string) - Hash a string") {
+	Hash::Hasher *hasher = resolveHasher(object);
+	if (hasher == NULL) {
+		TGE::Con::errorf("Hasher::update: %s is not a hasher!", object->getIdString());
+		return;
+	}
+	hasher->update(reinterpret_cast<const U8 *>(argv[2]), strlen(argv[2]));
+}
+
+MBX_CONSOLE_METHOD_NAMED(Hasher, updateFile, bool, 3, 3, "(path) - Hash the contents of a file") {
+	Hash::Hasher *hasher = resolveHasher(object);
+	if (hasher == NULL) {
+		TGE::Con::errorf("Hasher::updateFile: %s is not a hasher!", object->getIdString());
+		return false;
+	}
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[2]))
+		return false;
+
+	char path[256];
+	TGE::Con::expandScriptFilename(path, 256, argv[2]);
+	return Hash::hashFile(hasher, path);
+}
+
+MBX_CONSOLE_METHOD_NAMED(Hasher, digest, const char *, 2, 2, "() - Get the digest of everything hashed so far and start over") {
+	Hash::Hasher *hasher = resolveHasher(object);
+	if (hasher == NULL) {
+		TGE::Con::errorf("Hasher::digest: %s is not a hasher!", object->getIdString());
+		return "";
+	}
+	const char *digest = formatDigest(hasher);
+	hasher->reset();
+	return digest;
+}
+
+MBX_CONSOLE_METHOD_NAMED(Hasher, reset, void, 2, 2, "() - Start over without getting the digest") {
+	Hash::Hasher *hasher = resolveHasher(object);
+	if (hasher == NULL) {
+		TGE::Con::errorf("Hasher::reset: %s is not a hasher!", object->getIdString());
+		return;
+	}
+	hasher->reset();
+}
@@ -0,0 +1,377 @@
+//-----------------------------------------------------------------------------
+// LineReader.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// Buffered line reader for big text files. Reading a file through FileObject
+// costs a stream read, an allocation and a console return for every line. A
+// LineReader reads the file in large blocks and can hand script many lines or
+// the split fields of a delimited line in one call.
+
+#include <MBExtender/MBExtender.h>
+#include <MathLib/MathLib.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileExtension.h"
+
+#include <TorqueLib/console/console.h>
+#include <TorqueLib/console/simBase.h>
+#include <TorqueLib/console/scriptObject.h>
+
+MBX_MODULE(LineReader);
+
+#define LINE_READER_DEFAULT_BUFFER (64 * 1024)
+#define LINE_READER_MIN_BUFFER 256
+#define LINE_READER_MAX_BUFFER (16 * 1024 * 1024)
+
+class LineReader {
+public:
+	LineReader();
+	~LineReader();
+
+	bool open(const char *path, U32 bufferSize);
+	void close();
+
+	/**
+	 * Get the next line of the file, without its line ending. A final line
+	 * without a line ending is still returned.
+	 * @arg line Set to the start of the line. Only valid until the next call.
+	 * @arg length Set to the length of the line.
+	 * @return False if there are no more lines.
+	 */
+	bool nextLine(const char *&line, U32 &length);
+
+	bool isEOF();
+	U32 getLineNumber() const { return mLineNumber; }
+
+	//Scratch space for building return values, kept to avoid reallocating
+	std::string mScratch;
+
+private:
+	bool fill();
+
+	FILE *mFile;
+	std::vector<char> mBuffer;
+	//Unread data is [mStart, mEnd), and [mStart, mScanned) has no newlines
+	U32 mStart;
+	U32 mScanned;
+	U32 mEnd;
+	bool mEOF;
+	U32 mLineNumber;
+};
+
+LineReader::LineReader() : mFile(NULL), mStart(0), mScanned(0), mEnd(0), mEOF(true), mLineNumber(0) {
+}
+
+LineReader::~LineReader() {
+	close();
+}
+
+bool LineReader::open(const char *path, U32 bufferSize) {
+	close();
+
+	mFile = fopen(path, "rb");
+	if (mFile == NULL)
+		return false;
+
+	mBuffer.resize(bufferSize);
+	mEOF = false;
+	return true;
+}
+
+void LineReader::close() {
+	if (mFile != NULL)
+		fclose(mFile);
+	mFile = NULL;
+	mStart = mScanned = mEnd = 0;
+	mEOF = true;
+	mLineNumber = 0;
+}
+
+/**
+ * Read the next block of the file, keeping any unread data.
+ * @return False if nothing more could be read.
+ */
+bool LineReader::fill() {
+	if (mEOF)
+		return false;
+
+	//Move the partial line to the front, or grow if it fills the whole buffer
+	if (mStart > 0) {
+		memmove(&mBuffer[0], &mBuffer[mStart], mEnd - mStart);
+		mScanned -= mStart;
+		mEnd -= mStart;
+		mStart = 0;
+	} else if (mEnd == mBuffer.size()) {
+		mBuffer.resize(mBuffer.size() * 2);
+	}
+
+	size_t read = fread(&mBuffer[mEnd], 1, mBuffer.size() - mEnd, mFile);
+	if (read == 0) {
+		mEOF = true;
+		return false;
+	}
+	mEnd += static_cast<U32>(read);
+	return true;
+}
+
+bool LineReader::nextLine(const char *&line, U32 &length) {
+	while (true) {
+		const char *start = &mBuffer[0] + mStart;
+		const char *newline = static_cast<const char *>(memchr(&mBuffer[0] + mScanned, '\n', mEnd - mScanned));
+		if (newline != NULL) {
+			line = start;
+			length = static_cast<U32>(newline - start);
+			mStart = mScanned = static_cast<U32>(newline - &mBuffer[0]) + 1;
+			break;
+		}
+		mScanned = mEnd;
+
+		if (!fill()) {
+			//Last line without a line ending
+			if (mStart == mEnd)
+				return false;
+			line = &mBuffer[0] + mStart;
+			length = mEnd - mStart;
+			mStart = mScanned = mEnd;
+			break;
+		}
+	}
+
+	//Strip CR from CRLF line endings. A CRLF split between two reads still
+	// works since the CR stays in the buffer until the LF is found.
+	if (length > 0 && line[length - 1] == '\r')
+		length --;
+
+	mLineNumber ++;
+	return true;
+}
+
+bool LineReader::isEOF() {
+	if (mStart < mEnd)
+		return false;
+	return !fill();
+}
+
+/**
+ * Split a delimited line (like CSV) into tab-separated fields that can be used
+ * with getField(). Fields can be quoted to contain the delimiter, with "" for
+ * a literal quote. Tabs inside fields are replaced with spaces so they don't
+ * split the field.
+ * @arg line The line to split.
+ * @arg length The length of the line.
+ * @arg delimiter The field delimiter.
+ * @arg out The string to append the fields to.
+ */
+static void splitFields(const char *line, U32 length, char delimiter, std::string &out) {
+	const char *pos = line;
+	const char *end = line + length;
+
+	while (true) {
+		if (pos < end && *pos == '"') {
+			//Quoted field, runs until a quote that isn't doubled
+			for (pos ++; pos < end; pos ++) {
+				if (*pos == '"') {
+					if (pos + 1 < end && pos[1] == '"') {
+						out += '"';
+						pos ++;
+					} else {
+						pos ++;
+						break;
+					}
+				} else {
+					out += (*pos == '\t' ? ' ' : *pos);
+				}
+			}
+			//Anything between the closing quote and the delimiter is kept
+			while (pos < end && *pos != delimiter) {
+				out += (*pos == '\t' ? ' ' : *pos);
+				pos ++;
+			}
+		} else {
+			const char *fieldEnd = static_cast<const char *>(memchr(pos, delimiter, end - pos));
+			if (fieldEnd == NULL)
+				fieldEnd = end;
+			for (; pos < fieldEnd; pos ++) {
+				out += (*pos == '\t' ? ' ' : *pos);
+			}
+		}
+
+		if (pos >= end)
+			break;
+		//Skip the delimiter
+		pos ++;
+		out += '\t';
+	}
+}
+
+static const char *copyScratch(const std::string &scratch) {
+	char *buffer = TGE::Con::getReturnBuffer(scratch.size() + 1);
+	memcpy(buffer, scratch.c_str(), scratch.size() + 1);
+	return buffer;
+}
+
+//------------------------------------------------------------------------------
+// Keeping track of readers
+//------------------------------------------------------------------------------
+
+std::unordered_map<SimObjectId, LineReader *> gLineReaders;
+
+static LineReader *resolveLineReader(TGE::SimObject *object) {
+	std::unordered_map<SimObjectId, LineReader *>::iterator it = gLineReaders.find(object->getId());
+	if (it == gLineReaders.end())
+		return NULL;
+	return it->second;
+}
+
+MBX_OVERRIDE_MEMBERFN(void, TGE::SimObject::deleteObject, (TGE::SimObject *thisptr), originalDeleteObject) {
+	std::unordered_map<SimObjectId, LineReader *>::iterator it = gLineReaders.find(thisptr->getId());
+	if (it != gLineReaders.end()) {
+		delete it->second;
+		gLineReaders.erase(it);
+	}
+	originalDeleteObject(thisptr);
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(LineReader, S32, 2, 3, "LineReader(path[, bufferSize]) - Open a text file for reading lines. Returns 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+
+	char path[256];
+	TGE::Con::expandScriptFilename(path, 256, argv[1]);
+
+	U32 bufferSize = LINE_READER_DEFAULT_BUFFER;
+	if (argc > 2) {
+		bufferSize = mClamp(StringMath::scan<U32>(argv[2]), LINE_READER_MIN_BUFFER, LINE_READER_MAX_BUFFER);
+	}
+
+	LineReader *reader = new LineReader;
+	if (!reader->open(path, bufferSize)) {
+		TGE::Con::errorf("LineReader: Could not open %s", path);
+		delete reader;
+		return 0;
+	}
+
+	TGE::ScriptObject *object = TGE::ScriptObject::create();
+	object->mClassName = "LineReader";
+	object->mFlags |= TGE::SimObject::ModDynamicFields | TGE::SimObject::ModStaticFields;
+	object->registerObject();
+
+	gLineReaders[object->getId()] = reader;
+	return object->getId();
+}
+
+MBX_CONSOLE_FUNCTION(splitDelimited, const char *, 2, 3, "splitDelimited(line[, delimiter = \",\"]) - Split a delimited line into tab-separated fields") {
+	char delimiter = (argc > 2 && argv[2][0] != 0 ? argv[2][0] : ',');
+	std::string fields;
+	splitFields(argv[1], strlen(argv[1]), delimiter, fields);
+	return copyScratch(fields);
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, readLine, const char *, 2, 2, "() - Read the next line, without its line ending") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::readLine: %s is not a line reader!", object->getIdString());
+		return "";
+	}
+	const char *line;
+	U32 length;
+	if (!reader->nextLine(line, length))
+		return "";
+
+	char *buffer = TGE::Con::getReturnBuffer(length + 1);
+	memcpy(buffer, line, length);
+	buffer[length] = 0;
+	return buffer;
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, readLines, const char *, 3, 3, "(count) - Read up to count lines, separated by tabs. Use getFieldCount() to see how many were read.") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::readLines: %s is not a line reader!", object->getIdString());
+		return "";
+	}
+	U32 count = StringMath::scan<U32>(argv[2]);
+
+	reader->mScratch.clear();
+	const char *line;
+	U32 length;
+	for (U32 i = 0; i < count && reader->nextLine(line, length); i ++) {
+		if (i != 0)
+			reader->mScratch += '\t';
+		reader->mScratch.append(line, length);
+	}
+	return copyScratch(reader->mScratch);
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, readFields, const char *, 2, 3, "([delimiter = \",\"]) - Read the next line and split it into tab-separated fields") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::readFields: %s is not a line reader!", object->getIdString());
+		return "";
+	}
+	char delimiter = (argc > 2 && argv[2][0] != 0 ? argv[2][0] : ',');
+
+	const char *line;
+	U32 length;
+	if (!reader->nextLine(line, length))
+		return "";
+
+	reader->mScratch.clear();
+	splitFields(line, length, delimiter, reader->mScratch);
+	return copyScratch(reader->mScratch);
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, isEOF, bool, 2, 2, "() - Check if there are no more lines to read") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::isEOF: %s is not a line reader!", object->getIdString());
+		return true;
+	}
+	return reader->isEOF();
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, getLineNumber, S32, 2, 2, "() - Get the number of lines read so far") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::getLineNumber: %s is not a line reader!", object->getIdString());
+		return 0;
+	}
+	return reader->getLineNumber();
+}
+
+MBX_CONSOLE_METHOD_NAMED(LineReader, close, void, 2, 2, "() - Close the file. The reader will be at EOF afterwards.") {
+	LineReader *reader = resolveLineReader(object);
+	if (reader == NULL) {
+		TGE::Con::errorf("LineReader::close: %s is not a line reader!", object->getIdString());
+		return;
+	}
+	reader->close();
+}
@@ -0,0 +1,387 @@
+//-----------------------------------------------------------------------------
+// MappedFile.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// Read-only memory-mapped files. FileObject reads everything through the
+// engine's stream layer and keeps its own copy of the file, which is slow for
+// big read-only assets like replays. A MappedFile maps the file into memory
+// and lets script slice, search and iterate lines directly on the mapping.
+
+#include <MBExtender/MBExtender.h>
+#include <MathLib/MathLib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include "codec.h"
+#include "FileExtension.h"
+
+#include <TorqueLib/console/console.h>
+#include <TorqueLib/console/simBase.h>
+#include <TorqueLib/console/scriptObject.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MBX_MODULE(MappedFile);
+
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const char *path);
+	void close();
+
+	const U8 *getData() const { return mData; }
+	U32 getSize() const { return mSize; }
+
+	/**
+	 * Find a string in the file.
+	 * @arg needle The string to look for.
+	 * @arg start The offset to start searching at.
+	 * @return The offset of the first match, or -1 if there isn't one.
+	 */
+	S32 find(const char *needle, U32 start) const;
+
+	//Current position for line iteration
+	U32 mPosition;
+
+private:
+#ifdef _WIN32
+	HANDLE mFile;
+	HANDLE mMapping;
+#else
+	int mFd;
+#endif
+	const U8 *mData;
+	U32 mSize;
+};
+
+MappedFile::MappedFile() : mPosition(0), mData(NULL), mSize(0) {
+#ifdef _WIN32
+	mFile = INVALID_HANDLE_VALUE;
+	mMapping = NULL;
+#else
+	mFd = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(const char *path) {
+	close();
+
+#ifdef _WIN32
+	mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.HighPart != 0 || size.LowPart > S32_MAX) {
+		close();
+		return false;
+	}
+	mSize = size.LowPart;
+
+	//Mapping an empty file is an error, but reading one is not
+	if (mSize == 0)
+		return true;
+
+	mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMapping == NULL) {
+		close();
+		return false;
+	}
+	mData = static_cast<const U8 *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mData == NULL) {
+		close();
+		return false;
+	}
+#else
+	mFd = ::open(path, O_RDONLY);
+	if (mFd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(mFd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > S32_MAX) {
+		close();
+		return false;
+	}
+	mSize = static_cast<U32>(st.st_size);
+
+	//Mapping an empty file is an error, but reading one is not
+	if (mSize == 0)
+		return true;
+
+	void *data = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+	if (data == MAP_FAILED) {
+		close();
+		return false;
+	}
+	mData = static_cast<const U8 *>(data);
+#endif
+
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+	if (mData != NULL)
+		UnmapViewOfFile(mData);
+	if (mMapping != NULL)
+		CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mFile);
+	mMapping = NULL;
+	mFile = INVALID_HANDLE_VALUE;
+#else
+	if (mData != NULL)
+		munmap(const_cast<U8 *>(mData), mSize);
+	if (mFd >= 0)
+		::close(mFd);
+	mFd = -1;
+#endif
+	mData = NULL;
+	mSize = 0;
+	mPosition = 0;
+}
+
+S32 MappedFile::find(const char *needle, U32 start) const {
+	U32 needleLength = strlen(needle);
+	if (needleLength == 0 || start > mSize || needleLength > mSize - start)
+		return -1;
+
+	//Jump between occurrences of the first character, then compare the rest
+	const U8 *pos = mData + start;
+	const U8 *last = mData + mSize - needleLength;
+	while (pos <= last) {
+		pos = static_cast<const U8 *>(memchr(pos, needle[0], last - pos + 1));
+		if (pos == NULL)
+			return -1;
+		if (memcmp(pos, needle, needleLength) == 0)
+			return static_cast<S32>(pos - mData);
+		pos ++;
+	}
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// Keeping track of mapped files
+//------------------------------------------------------------------------------
+
+std::unordered_map<SimObjectId, MappedFile *> gMappedFiles;
+
+static MappedFile *resolveMappedFile(TGE::SimObject *object) {
+	std::unordered_map<SimObjectId, MappedFile *>::iterator it = gMappedFiles.find(object->getId());
+	if (it == gMappedFiles.end())
+		return NULL;
+	return it->second;
+}
+
+MBX_OVERRIDE_MEMBERFN(void, TGE::SimObject::deleteObject, (TGE::SimObject *thisptr), originalDeleteObject) {
+	std::unordered_map<SimObjectId, MappedFile *>::iterator it = gMappedFiles.find(thisptr->getId());
+	if (it != gMappedFiles.end()) {
+		delete it->second;
+		gMappedFiles.erase(it);
+	}
+	originalDeleteObject(thisptr);
+}
+
+/**
+ * Clamp a slice of the file to its bounds.
+ * @arg file The mapped file.
+ * @arg offsetStr The script's offset argument.
+ * @arg lengthStr The script's length argument, or NULL for "to the end".
+ * @arg offset Set to the start of the slice.
+ * @arg length Set to the length of the slice.
+ */
+static void getSlice(const MappedFile *file, const char *offsetStr, const char *lengthStr, U32 &offset, U32 &length) {
+	offset = StringMath::scan<U32>(offsetStr);
+	if (offset > file->getSize())
+		offset = file->getSize();
+	length = file->getSize() - offset;
+	if (lengthStr != NULL) {
+		U32 requested = StringMath::scan<U32>(lengthStr);
+		if (requested < length)
+			length = requested;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(MappedFile, S32, 2, 2, "MappedFile(path) - Map a file into memory for reading. Returns 0 on failure.") {
+	//HOLY SHIT BATMAN SECURITY HOLE PARTY
+	if (!pathCheck(argv[1]))
+		return 0;
+
+	char path[256];
+	TGE::Con::expandScriptFilename(path, 256, argv[1]);
+
+	MappedFile *file = new MappedFile;
+	if (!file->open(path)) {
+		TGE::Con::errorf("MappedFile: Could not map %s", path);
+		delete file;
+		return 0;
+	}
+
+	TGE::ScriptObject *object = TGE::ScriptObject::create();
+	object->mClassName = "MappedFile";
+	object->mFlags |= TGE::SimObject::ModDynamicFields | TGE::SimObject::ModStaticFields;
+	object->registerObject();
+
+	gMappedFiles[object->getId()] = file;
+	return object->getId();
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, getSize, const char *, 2, 2, "() - Get the size of the file, in bytes") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::getSize: %s is not a mapped file!", object->getIdString());
+		return "0";
+	}
+	return StringMath::print(file->getSize());
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, slice, const char *, 3, 4, "(offset[, length]) - Get part of the file as a string") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::slice: %s is not a mapped file!", object->getIdString());
+		return "";
+	}
+	U32 offset, length;
+	getSlice(file, argv[2], argc > 3 ? argv[3] : NULL, offset, length);
+
+	char *buffer = TGE::Con::getReturnBuffer(length + 1);
+	memcpy(buffer, file->getData() + offset, length);
+	buffer[length] = 0;
+	return buffer;
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, sliceHex, const char *, 3, 4, "(offset[, length]) - Get part of the file as a hex string") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::sliceHex: %s is not a mapped file!", object->getIdString());
+		return "";
+	}
+	U32 offset, length;
+	getSlice(file, argv[2], argc > 3 ? argv[3] : NULL, offset, length);
+
+	size_t encodedLength = Codec::hexEncodedLength(length);
+	char *buffer = TGE::Con::getReturnBuffer(encodedLength + 1);
+	Codec::hexEncode(buffer, file->getData() + offset, length);
+	buffer[encodedLength] = 0;
+	return buffer;
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, sliceBase64, const char *, 3, 4, "(offset[, length]) - Get part of the file as a base64 string") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::sliceBase64: %s is not a mapped file!", object->getIdString());
+		return "";
+	}
+	U32 offset, length;
+	getSlice(file, argv[2], argc > 3 ? argv[3] : NULL, offset, length);
+
+	size_t encodedLength = Codec::base64EncodedLength(length);
+	char *buffer = TGE::Con::getReturnBuffer(encodedLength + 1);
+	Codec::base64Encode(buffer, file->getData() + offset, length);
+	buffer[encodedLength] = 0;
+	return buffer;
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, find, S32, 3, 4, "(string[, start = 0]) - Find the offset of a string in the file, or -1") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::find: %s is not a mapped file!", object->getIdString());
+		return -1;
+	}
+	return file->find(argv[2], argc > 3 ? StringMath::scan<U32>(argv[3]) : 0);
+}
+
+//------------------------------------------------------------------------------
+// Line iteration
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, readLine, const char *, 2, 2, "() - Read the next line, without its line ending") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::readLine: %s is not a mapped file!", object->getIdString());
+		return "";
+	}
+	if (file->mPosition >= file->getSize())
+		return "";
+
+	const U8 *start = file->getData() + file->mPosition;
+	U32 remaining = file->getSize() - file->mPosition;
+	const U8 *newline = static_cast<const U8 *>(memchr(start, '\n', remaining));
+
+	U32 length = (newline != NULL ? newline - start : remaining);
+	file->mPosition += (newline != NULL ? length + 1 : length);
+
+	//Strip CR from CRLF line endings
+	if (length > 0 && start[length - 1] == '\r')
+		length --;
+
+	char *buffer = TGE::Con::getReturnBuffer(length + 1);
+	memcpy(buffer, start, length);
+	buffer[length] = 0;
+	return buffer;
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, isEOF, bool, 2, 2, "() - Check if readLine() has reached the end of the file") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::isEOF: %s is not a mapped file!", object->getIdString());
+		return true;
+	}
+	return file->mPosition >= file->getSize();
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, getPosition, const char *, 2, 2, "() - Get the offset that readLine() will read from next") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::getPosition: %s is not a mapped file!", object->getIdString());
+		return "0";
+	}
+	return StringMath::print(file->mPosition);
+}
+
+MBX_CONSOLE_METHOD_NAMED(MappedFile, setPosition, void, 3, 3, "(offset) - Set the offset that readLine() will read from next") {
+	MappedFile *file = resolveMappedFile(object);
+	if (file == NULL) {
+		TGE::Con::errorf("MappedFile::setPosition: %s is not a mapped file!", object->getIdString());
+		return;
+	}
+	U32 position = StringMath::scan<U32>(argv[2]);
+	file->mPosition = (position > file->getSize() ? file->getSize() : position);
+}
@@ -0,0 +1,425 @@
+//-----------------------------------------------------------------------------
+// codec.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "codec.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define CODEC_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#else
+#define CODEC_X86 0
+#endif
+
+//Clang needs to be told which functions are allowed to use newer instructions.
+// MSVC lets you use any intrinsic anywhere.
+#if defined(__clang__) || defined(__GNUC__)
+#define CODEC_TARGET(x) __attribute__((target(x)))
+#else
+#define CODEC_TARGET(x)
+#endif
+
+namespace Codec {
+	//The SIMD loops only handle whole blocks of valid input and return how much
+	// of it they consumed. The scalar code picks up wherever they stop.
+	typedef size_t (*EncodeBlocksFn)(char *out, const uint8_t *in, size_t length);
+	typedef size_t (*DecodeBlocksFn)(uint8_t *out, const char *in, size_t length);
+
+	static EncodeBlocksFn gHexEncodeBlocks = NULL;
+	static DecodeBlocksFn gHexDecodeBlocks = NULL;
+	static EncodeBlocksFn gBase64EncodeBlocks = NULL;
+	static DecodeBlocksFn gBase64DecodeBlocks = NULL;
+
+	static const uint8_t Invalid = 0xFF;
+	static const uint8_t Padding = 0xFE;
+
+	static const char HexDigits[] = "0123456789ABCDEF";
+	static const char Base64Digits[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz"
+		"0123456789+/";
+
+	static uint8_t gHexValues[256];
+	static uint8_t gBase64Strict[256];
+	static uint8_t gBase64Lenient[256];
+
+	static void buildTables() {
+		for (int i = 0; i < 256; i ++) {
+			gHexValues[i] = Invalid;
+			gBase64Strict[i] = Invalid;
+			gBase64Lenient[i] = Invalid;
+		}
+		for (int i = 0; i < 16; i ++) {
+			gHexValues[static_cast<uint8_t>(HexDigits[i])] = i;
+			if (i >= 10) {
+				gHexValues[static_cast<uint8_t>(HexDigits[i] - 'A' + 'a')] = i;
+			}
+		}
+		for (int i = 0; i < 64; i ++) {
+			gBase64Strict[static_cast<uint8_t>(Base64Digits[i])] = i;
+			gBase64Lenient[static_cast<uint8_t>(Base64Digits[i])] = i;
+		}
+		gBase64Strict['='] = Padding;
+		gBase64Lenient['='] = Padding;
+		//URL-safe alphabet
+		gBase64Lenient['-'] = 62;
+		gBase64Lenient['_'] = 63;
+	}
+
+#if CODEC_X86
+
+	//--------------------------------------------------------------------------
+	// Hex (SSE2)
+	//--------------------------------------------------------------------------
+
+	CODEC_TARGET("sse2")
+	static inline __m128i hexNibblesToAscii(__m128i nibbles) {
+		//'0' + n, plus 7 more to get from ':' to 'A' when n > 9
+		__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+		return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+	}
+
+	CODEC_TARGET("sse2")
+	static size_t hexEncodeBlocksSSE2(char *out, const uint8_t *in, size_t length) {
+		const __m128i mask = _mm_set1_epi8(0x0F);
+
+		size_t consumed = 0;
+		while (length - consumed >= 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+			__m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+			__m128i lo = _mm_and_si128(bytes, mask);
+
+			//High nibble comes first in the output
+			__m128i first = hexNibblesToAscii(_mm_unpacklo_epi8(hi, lo));
+			__m128i second = hexNibblesToAscii(_mm_unpackhi_epi8(hi, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + consumed * 2), first);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + consumed * 2 + 16), second);
+
+			consumed += 16;
+		}
+		return consumed;
+	}
+
+	/**
+	 * Decode 16 hex characters into 8 bytes, each stored in a 16-bit lane.
+	 * @arg valid Set to false if any of the characters are not hex digits.
+	 */
+	CODEC_TARGET("sse2")
+	static inline __m128i hexDecode16(const char *in, bool &valid) {
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+
+		//Unsigned range checks: x is in [0, n] if min(x, n) == x
+		__m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+		__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		__m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+		valid = (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == 0xFFFF);
+
+		__m128i values = _mm_or_si128(
+			_mm_and_si128(isDigit, digit),
+			_mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+
+		//Each 16-bit lane holds (high nibble, low nibble), combine them
+		__m128i hi = _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 4);
+		__m128i lo = _mm_srli_epi16(values, 8);
+		return _mm_or_si128(hi, lo);
+	}
+
+	CODEC_TARGET("sse2")
+	static size_t hexDecodeBlocksSSE2(uint8_t *out, const char *in, size_t length) {
+		size_t consumed = 0;
+		while (length - consumed >= 32) {
+			bool validFirst, validSecond;
+			__m128i first = hexDecode16(in + consumed, validFirst);
+			__m128i second = hexDecode16(in + consumed + 16, validSecond);
+			if (!validFirst || !validSecond)
+				break;
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + consumed / 2), _mm_packus_epi16(first, second));
+			consumed += 32;
+		}
+		return consumed;
+	}
+
+	//--------------------------------------------------------------------------
+	// Base64 (SSSE3)
+	//
+	// These follow Wojciech Muła's vectorized base64 algorithms, as used in
+	// Alfred Klomp's base64 library.
+	//--------------------------------------------------------------------------
+
+	CODEC_TARGET("ssse3")
+	static size_t base64EncodeBlocksSSSE3(char *out, const uint8_t *in, size_t length) {
+		const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+		const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+
+		size_t consumed = 0;
+		char *pos = out;
+
+		//Each iteration uses 12 bytes but loads 16
+		while (length - consumed >= 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+
+			//Spread each group of 3 bytes into 4 6-bit indices
+			bytes = _mm_shuffle_epi8(bytes, shuffle);
+			__m128i t0 = _mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00));
+			__m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+			__m128i t2 = _mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0));
+			__m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+			__m128i indices = _mm_or_si128(t1, t3);
+
+			//Translate indices into characters by adding a per-range offset
+			__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			range = _mm_sub_epi8(range, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+			__m128i chars = _mm_add_epi8(indices, _mm_shuffle_epi8(lut, range));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pos), chars);
+			pos += 16;
+			consumed += 12;
+		}
+		return consumed;
+	}
+
+	CODEC_TARGET("ssse3")
+	static size_t base64DecodeBlocksSSSE3(uint8_t *out, const char *in, size_t length) {
+		const __m128i lutLo = _mm_setr_epi8(
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m128i lutHi = _mm_setr_epi8(
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i lutRoll = _mm_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71,
+			0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i mask2F = _mm_set1_epi8(0x2F);
+		const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+		size_t consumed = 0;
+		uint8_t *pos = out;
+
+		//Each iteration writes 16 bytes but only 12 are valid. Stopping 24
+		// characters early guarantees the caller's buffer has room for that.
+		while (length - consumed >= 24) {
+			__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+
+			//Classify characters by nibble, anything outside the alphabet
+			// (including padding) stops the loop
+			__m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), mask2F);
+			__m128i loNibbles = _mm_and_si128(chars, mask2F);
+			__m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+			__m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF)
+				break;
+
+			//Convert characters to 6-bit values
+			__m128i eq2F = _mm_cmpeq_epi8(chars, mask2F);
+			__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+			__m128i values = _mm_add_epi8(chars, roll);
+
+			//Pack 4 6-bit values into 3 bytes
+			__m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+			merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+			merged = _mm_shuffle_epi8(merged, pack);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pos), merged);
+			pos += 12;
+			consumed += 16;
+		}
+		return consumed;
+	}
+
+#endif
+
+	//--------------------------------------------------------------------------
+	// Public interface
+	//--------------------------------------------------------------------------
+
+	void init(MBX_CpuFeatures features) {
+		buildTables();
+
+#if CODEC_X86
+		if (features & MBX_CPU_SSE2) {
+			gHexEncodeBlocks = hexEncodeBlocksSSE2;
+			gHexDecodeBlocks = hexDecodeBlocksSSE2;
+		}
+		if (features & MBX_CPU_SSSE3) {
+			gBase64EncodeBlocks = base64EncodeBlocksSSSE3;
+			gBase64DecodeBlocks = base64DecodeBlocksSSSE3;
+		}
+#endif
+	}
+
+	void hexEncode(char *out, const uint8_t *in, size_t length) {
+		size_t i = 0;
+		if (gHexEncodeBlocks != NULL) {
+			i = gHexEncodeBlocks(out, in, length);
+		}
+		for (; i < length; i ++) {
+			out[i * 2] = HexDigits[in[i] >> 4];
+			out[i * 2 + 1] = HexDigits[in[i] & 0x0F];
+		}
+	}
+
+	bool hexDecode(uint8_t *out, size_t *outLength, const char *in, size_t length, bool strict) {
+		uint8_t *start = out;
+		const char *end = in + length;
+
+		uint8_t high = 0;
+		bool haveHigh = false;
+		while (in < end) {
+			//Try to do a big chunk at once whenever we're between bytes
+			if (!haveHigh && gHexDecodeBlocks != NULL) {
+				size_t consumed = gHexDecodeBlocks(out, in, end - in);
+				in += consumed;
+				out += consumed / 2;
+				if (in == end)
+					break;
+			}
+
+			uint8_t value = gHexValues[static_cast<uint8_t>(*in++)];
+			if (value == Invalid) {
+				if (strict) {
+					*outLength = out - start;
+					return false;
+				}
+				continue;
+			}
+
+			if (haveHigh) {
+				*out++ = static_cast<uint8_t>((high << 4) | value);
+				haveHigh = false;
+			} else {
+				high = value;
+				haveHigh = true;
+			}
+		}
+
+		*outLength = out - start;
+		//A dangling nibble is dropped in lenient mode
+		return !(strict && haveHigh);
+	}
+
+	void base64Encode(char *out, const uint8_t *in, size_t length) {
+		size_t i = 0;
+		if (gBase64EncodeBlocks != NULL) {
+			i = gBase64EncodeBlocks(out, in, length);
+			out += i / 3 * 4;
+		}
+		for (; i + 3 <= length; i += 3) {
+			uint32_t group = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+			*out++ = Base64Digits[(group >> 18) & 0x3F];
+			*out++ = Base64Digits[(group >> 12) & 0x3F];
+			*out++ = Base64Digits[(group >> 6) & 0x3F];
+			*out++ = Base64Digits[group & 0x3F];
+		}
+
+		//Pad out the last group
+		size_t remaining = length - i;
+		if (remaining == 1) {
+			uint32_t group = (in[i] << 16);
+			*out++ = Base64Digits[(group >> 18) & 0x3F];
+			*out++ = Base64Digits[(group >> 12) & 0x3F];
+			*out++ = '=';
+			*out++ = '=';
+		} else if (remaining == 2) {
+			uint32_t group = (in[i] << 16) | (in[i + 1] << 8);
+			*out++ = Base64Digits[(group >> 18) & 0x3F];
+			*out++ = Base64Digits[(group >> 12) & 0x3F];
+			*out++ = Base64Digits[(group >> 6) & 0x3F];
+			*out++ = '=';
+		}
+	}
+
+	bool base64Decode(uint8_t *out, size_t *outLength, const char *in, size_t length, bool strict) {
+		uint8_t *start = out;
+		const char *end = in + length;
+		const uint8_t *table = (strict ? gBase64Strict : gBase64Lenient);
+
+		*outLength = 0;
+		if (strict && length % 4 != 0)
+			return false;
+
+		uint32_t group = 0;
+		int count = 0;
+		int padding = 0;
+		while (in < end) {
+			//Try to do a big chunk at once whenever we're between groups
+			if (count == 0 && padding == 0 && gBase64DecodeBlocks != NULL) {
+				size_t consumed = gBase64DecodeBlocks(out, in, end - in);
+				in += consumed;
+				out += consumed / 4 * 3;
+				if (in == end)
+					break;
+			}
+
+			uint8_t value = table[static_cast<uint8_t>(*in++)];
+			if (value == Invalid) {
+				if (strict) {
+					*outLength = out - start;
+					return false;
+				}
+				continue;
+			}
+			if (value == Padding) {
+				//Lenient mode just ignores padding
+				if (strict) {
+					//Padding can only finish off a group of 2 or 3 characters
+					if (count < 2 || count + padding >= 4) {
+						*outLength = out - start;
+						return false;
+					}
+					padding ++;
+				}
+				continue;
+			}
+			if (padding > 0) {
+				//Data after padding
+				*outLength = out - start;
+				return false;
+			}
+
+			group = (group << 6) | value;
+			if (++ count == 4) {
+				*out++ = static_cast<uint8_t>(group >> 16);
+				*out++ = static_cast<uint8_t>(group >> 8);
+				*out++ = static_cast<uint8_t>(group);
+				group = 0;
+				count = 0;
+			}
+		}
+
+		//Leftover characters from an unpadded (or padded) final group
+		if (count == 2) {
+			*out++ = static_cast<uint8_t>(group >> 4);
+		} else if (count == 3) {
+			*out++ = static_cast<uint8_t>(group >> 10);
+			*out++ = static_cast<uint8_t>(group >> 2);
+		}
+
+		*outLength = out - start;
+		//A single leftover character can't make a byte, lenient mode drops it
+		return !(strict && count != 0 && count + padding != 4);
+	}
+}
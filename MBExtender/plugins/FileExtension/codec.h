@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// codec.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <MBExtender/Interface.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Hex and base64 codecs used by the FileObject raw data methods. Each codec
+ * has a scalar implementation and an SSE2/SSSE3 one which is picked at
+ * startup based on the CPU features reported by the plugin loader.
+ *
+ * Decoders have two modes. Strict decoding fails on anything that isn't
+ * canonical input. Lenient decoding skips characters it doesn't understand
+ * (whitespace, separators, line breaks), accepts the URL-safe base64
+ * alphabet, and doesn't require padding, which matches what the old decoders
+ * would accept.
+ */
+namespace Codec {
+	/**
+	 * Pick the fastest implementations supported by the CPU.
+	 * @arg features The CPU features detected by the plugin loader.
+	 */
+	void init(MBX_CpuFeatures features);
+
+	/**
+	 * Encode bytes as uppercase hex.
+	 * @arg out Output buffer, must hold hexEncodedLength(length) chars. No
+	 *          terminator is written.
+	 * @arg in The bytes to encode.
+	 * @arg length The number of bytes to encode.
+	 */
+	void hexEncode(char *out, const uint8_t *in, size_t length);
+
+	/**
+	 * Decode a hex string.
+	 * @arg out Output buffer, must hold hexDecodedMaxLength(length) bytes.
+	 * @arg outLength Set to the number of bytes written.
+	 * @arg in The hex characters to decode.
+	 * @arg length The number of characters to decode.
+	 * @arg strict If true, fail on odd lengths and non-hex characters.
+	 * @return Whether the input was decoded successfully.
+	 */
+	bool hexDecode(uint8_t *out, size_t *outLength, const char *in, size_t length, bool strict);
+
+	/**
+	 * Encode bytes as padded base64.
+	 * @arg out Output buffer, must hold base64EncodedLength(length) chars. No
+	 *          terminator is written.
+	 * @arg in The bytes to encode.
+	 * @arg length The number of bytes to encode.
+	 */
+	void base64Encode(char *out, const uint8_t *in, size_t length);
+
+	/**
+	 * Decode a base64 string.
+	 * @arg out Output buffer, must hold base64DecodedMaxLength(length) bytes.
+	 * @arg outLength Set to the number of bytes written.
+	 * @arg in The base64 characters to decode.
+	 * @arg length The number of characters to decode.
+	 * @arg strict If true, fail on anything other than padded standard base64.
+	 * @return Whether the input was decoded successfully.
+	 */
+	bool base64Decode(uint8_t *out, size_t *outLength, const char *in, size_t length, bool strict);
+
+	inline size_t hexEncodedLength(size_t length) {
+		return length * 2;
+	}
+	inline size_t hexDecodedMaxLength(size_t length) {
+		return length / 2;
+	}
+	inline size_t base64EncodedLength(size_t length) {
+		return (length + 2) / 3 * 4;
+	}
+	inline size_t base64DecodedMaxLength(size_t length) {
+		return (length + 3) / 4 * 3;
+	}
+}
@@ -0,0 +1,396 @@
+//-----------------------------------------------------------------------------
+// hash.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#ifdef _WIN32
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#endif
+
+namespace Hash {
+	bool findAlgorithm(const char *name, Algorithm &algorithm) {
+		if (strcasecmp(name, "crc32") == 0) {
+			algorithm = CRC32;
+		} else if (strcasecmp(name, "xxh64") == 0 || strcasecmp(name, "xxhash64") == 0) {
+			algorithm = XXH64;
+		} else if (strcasecmp(name, "sha256") == 0 || strcasecmp(name, "sha-256") == 0) {
+			algorithm = SHA256;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	static inline void storeBigEndian32(uint8_t *out, uint32_t value) {
+		out[0] = static_cast<uint8_t>(value >> 24);
+		out[1] = static_cast<uint8_t>(value >> 16);
+		out[2] = static_cast<uint8_t>(value >> 8);
+		out[3] = static_cast<uint8_t>(value);
+	}
+
+	static inline void storeBigEndian64(uint8_t *out, uint64_t value) {
+		storeBigEndian32(out, static_cast<uint32_t>(value >> 32));
+		storeBigEndian32(out + 4, static_cast<uint32_t>(value));
+	}
+
+	static inline uint32_t loadBigEndian32(const uint8_t *in) {
+		return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+	}
+
+	//Both targets are little endian
+	static inline uint64_t loadLittleEndian64(const uint8_t *in) {
+		uint64_t value;
+		memcpy(&value, in, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t loadLittleEndian32(const uint8_t *in) {
+		uint32_t value;
+		memcpy(&value, in, sizeof(value));
+		return value;
+	}
+
+	//--------------------------------------------------------------------------
+	// CRC32, zlib already has a fast implementation
+	//--------------------------------------------------------------------------
+
+	class Crc32Hasher : public Hasher {
+	public:
+		Crc32Hasher() { reset(); }
+
+		void reset() override {
+			mCrc = crc32(0L, Z_NULL, 0);
+		}
+
+		void update(const uint8_t *data, size_t length) override {
+			//zlib takes a uInt length
+			while (length > 0) {
+				uInt block = (length > 0x40000000 ? 0x40000000 : static_cast<uInt>(length));
+				mCrc = crc32(mCrc, data, block);
+				data += block;
+				length -= block;
+			}
+		}
+
+		size_t finish(uint8_t *digest) override {
+			storeBigEndian32(digest, static_cast<uint32_t>(mCrc));
+			return 4;
+		}
+
+	private:
+		uLong mCrc;
+	};
+
+	//--------------------------------------------------------------------------
+	// xxHash64, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+	//--------------------------------------------------------------------------
+
+	static const uint64_t XXH_PRIME1 = 11400714785074694791ULL;
+	static const uint64_t XXH_PRIME2 = 14029467366897019727ULL;
+	static const uint64_t XXH_PRIME3 = 1609587929392839161ULL;
+	static const uint64_t XXH_PRIME4 = 9650029242287828579ULL;
+	static const uint64_t XXH_PRIME5 = 2870177450012600261ULL;
+
+	static inline uint64_t rotl64(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	static inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+		acc += input * XXH_PRIME2;
+		acc = rotl64(acc, 31);
+		return acc * XXH_PRIME1;
+	}
+
+	static inline uint64_t xxhMergeRound(uint64_t acc, uint64_t value) {
+		acc ^= xxhRound(0, value);
+		return acc * XXH_PRIME1 + XXH_PRIME4;
+	}
+
+	class Xxh64Hasher : public Hasher {
+	public:
+		Xxh64Hasher() { reset(); }
+
+		void reset() override {
+			mAcc[0] = XXH_PRIME1 + XXH_PRIME2;
+			mAcc[1] = XXH_PRIME2;
+			mAcc[2] = 0;
+			mAcc[3] = 0 - XXH_PRIME1;
+			mTotalLength = 0;
+			mBufferLength = 0;
+		}
+
+		void update(const uint8_t *data, size_t length) override {
+			mTotalLength += length;
+
+			//Finish a stripe left over from the last update
+			if (mBufferLength > 0) {
+				size_t needed = 32 - mBufferLength;
+				if (length < needed) {
+					memcpy(mBuffer + mBufferLength, data, length);
+					mBufferLength += length;
+					return;
+				}
+				memcpy(mBuffer + mBufferLength, data, needed);
+				processStripe(mBuffer);
+				data += needed;
+				length -= needed;
+				mBufferLength = 0;
+			}
+
+			while (length >= 32) {
+				processStripe(data);
+				data += 32;
+				length -= 32;
+			}
+
+			memcpy(mBuffer, data, length);
+			mBufferLength = length;
+		}
+
+		size_t finish(uint8_t *digest) override {
+			uint64_t hash;
+			if (mTotalLength >= 32) {
+				hash = rotl64(mAcc[0], 1) + rotl64(mAcc[1], 7) + rotl64(mAcc[2], 12) + rotl64(mAcc[3], 18);
+				for (int i = 0; i < 4; i++) {
+					hash = xxhMergeRound(hash, mAcc[i]);
+				}
+			} else {
+				hash = XXH_PRIME5;
+			}
+			hash += mTotalLength;
+
+			const uint8_t *pos = mBuffer;
+			const uint8_t *end = mBuffer + mBufferLength;
+			for (; pos + 8 <= end; pos += 8) {
+				hash ^= xxhRound(0, loadLittleEndian64(pos));
+				hash = rotl64(hash, 27) * XXH_PRIME1 + XXH_PRIME4;
+			}
+			if (pos + 4 <= end) {
+				hash ^= uint64_t(loadLittleEndian32(pos)) * XXH_PRIME1;
+				hash = rotl64(hash, 23) * XXH_PRIME2 + XXH_PRIME3;
+				pos += 4;
+			}
+			for (; pos < end; pos++) {
+				hash ^= *pos * XXH_PRIME5;
+				hash = rotl64(hash, 11) * XXH_PRIME1;
+			}
+
+			hash ^= hash >> 33;
+			hash *= XXH_PRIME2;
+			hash ^= hash >> 29;
+			hash *= XXH_PRIME3;
+			hash ^= hash >> 32;
+
+			storeBigEndian64(digest, hash);
+			return 8;
+		}
+
+	private:
+		void processStripe(const uint8_t *stripe) {
+			for (int i = 0; i < 4; i++) {
+				mAcc[i] = xxhRound(mAcc[i], loadLittleEndian64(stripe + i * 8));
+			}
+		}
+
+		uint64_t mAcc[4];
+		uint64_t mTotalLength;
+		uint8_t mBuffer[32];
+		size_t mBufferLength;
+	};
+
+	//--------------------------------------------------------------------------
+	// SHA-256, FIPS 180-4
+	//--------------------------------------------------------------------------
+
+	static const uint32_t SHA256_K[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	static inline uint32_t rotr32(uint32_t value, int bits) {
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+	class Sha256Hasher : public Hasher {
+	public:
+		Sha256Hasher() { reset(); }
+
+		void reset() override {
+			static const uint32_t initial[8] = {
+				0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+			};
+			memcpy(mState, initial, sizeof(mState));
+			mTotalLength = 0;
+			mBufferLength = 0;
+		}
+
+		void update(const uint8_t *data, size_t length) override {
+			mTotalLength += length;
+
+			if (mBufferLength > 0) {
+				size_t needed = 64 - mBufferLength;
+				if (length < needed) {
+					memcpy(mBuffer + mBufferLength, data, length);
+					mBufferLength += length;
+					return;
+				}
+				memcpy(mBuffer + mBufferLength, data, needed);
+				processBlock(mBuffer);
+				data += needed;
+				length -= needed;
+				mBufferLength = 0;
+			}
+
+			while (length >= 64) {
+				processBlock(data);
+				data += 64;
+				length -= 64;
+			}
+
+			memcpy(mBuffer, data, length);
+			mBufferLength = length;
+		}
+
+		size_t finish(uint8_t *digest) override {
+			uint64_t bitLength = mTotalLength * 8;
+
+			//Pad with a 1 bit, zeros, then the length in the last 8 bytes
+			mBuffer[mBufferLength++] = 0x80;
+			if (mBufferLength > 56) {
+				memset(mBuffer + mBufferLength, 0, 64 - mBufferLength);
+				processBlock(mBuffer);
+				mBufferLength = 0;
+			}
+			memset(mBuffer + mBufferLength, 0, 56 - mBufferLength);
+			storeBigEndian64(mBuffer + 56, bitLength);
+			processBlock(mBuffer);
+			mBufferLength = 0;
+
+			for (int i = 0; i < 8; i++) {
+				storeBigEndian32(digest + i * 4, mState[i]);
+			}
+			return 32;
+		}
+
+	private:
+		void processBlock(const uint8_t *block) {
+			uint32_t w[64];
+			for (int i = 0; i < 16; i++) {
+				w[i] = loadBigEndian32(block + i * 4);
+			}
+			for (int i = 16; i < 64; i++) {
+				uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+				uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+				w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+			}
+
+			uint32_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+			uint32_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+			for (int i = 0; i < 64; i++) {
+				uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+				uint32_t ch = (e & f) ^ (~e & g);
+				uint32_t temp1 = h + s1 + ch + SHA256_K[i] + w[i];
+				uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+				uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+				uint32_t temp2 = s0 + maj;
+
+				h = g;
+				g = f;
+				f = e;
+				e = d + temp1;
+				d = c;
+				c = b;
+				b = a;
+				a = temp1 + temp2;
+			}
+
+			mState[0] += a;
+			mState[1] += b;
+			mState[2] += c;
+			mState[3] += d;
+			mState[4] += e;
+			mState[5] += f;
+			mState[6] += g;
+			mState[7] += h;
+		}
+
+		uint32_t mState[8];
+		uint64_t mTotalLength;
+		uint8_t mBuffer[64];
+		size_t mBufferLength;
+	};
+
+	Hasher *Hasher::create(Algorithm algorithm) {
+		switch (algorithm) {
+			case CRC32:  return new Crc32Hasher;
+			case XXH64:  return new Xxh64Hasher;
+			case SHA256: return new Sha256Hasher;
+			default:     return NULL;
+		}
+	}
+
+	size_t finishHex(Hasher *hasher, char *out) {
+		static const char digits[] = "0123456789abcdef";
+
+		uint8_t digest[MaxDigestLength];
+		size_t length = hasher->finish(digest);
+		for (size_t i = 0; i < length; i++) {
+			out[i * 2] = digits[digest[i] >> 4];
+			out[i * 2 + 1] = digits[digest[i] & 0xF];
+		}
+		out[length * 2] = 0;
+		return length * 2;
+	}
+
+	bool hashFile(Hasher *hasher, const char *path, const std::atomic<bool> *cancel) {
+		FILE *file = fopen(path, "rb");
+		if (file == NULL)
+			return false;
+
+		uint8_t buffer[64 * 1024];
+		size_t read;
+		bool cancelled = false;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			if (cancel != NULL && cancel->load()) {
+				cancelled = true;
+				break;
+			}
+			hasher->update(buffer, read);
+		}
+		bool error = (ferror(file) != 0);
+		fclose(file);
+		return !error && !cancelled;
+	}
+}
@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+// hash.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Streaming hash functions used by the hashing console functions. All of them
+ * can be fed data in pieces and produce the same digest as hashing the data
+ * in one go. Digests are in the standard byte order for each algorithm, so
+ * hex encoding them gives the usual printed form.
+ */
+namespace Hash {
+	enum Algorithm {
+		CRC32,
+		XXH64,
+		SHA256
+	};
+
+	//Large enough for any digest
+	const size_t MaxDigestLength = 32;
+
+	/**
+	 * Look up an algorithm by its script name ("crc32", "xxh64", "sha256").
+	 * @arg name The name of the algorithm, case insensitive.
+	 * @arg algorithm Set to the algorithm if it was found.
+	 * @return Whether the name is a known algorithm.
+	 */
+	bool findAlgorithm(const char *name, Algorithm &algorithm);
+
+	class Hasher {
+	public:
+		virtual ~Hasher() {}
+
+		/**
+		 * Create a hasher for an algorithm.
+		 */
+		static Hasher *create(Algorithm algorithm);
+
+		/**
+		 * Start over as if no data had been hashed.
+		 */
+		virtual void reset() = 0;
+
+		/**
+		 * Hash more data.
+		 */
+		virtual void update(const uint8_t *data, size_t length) = 0;
+
+		/**
+		 * Get the digest of all data hashed since the last reset. The hasher
+		 * must be reset before it can be used again.
+		 * @arg digest Output buffer, must hold MaxDigestLength bytes.
+		 * @return The length of the digest in bytes.
+		 */
+		virtual size_t finish(uint8_t *digest) = 0;
+	};
+
+	/**
+	 * Finish a hasher and write its digest as lowercase hex.
+	 * @arg hasher The hasher to finish.
+	 * @arg out Output buffer, must hold MaxDigestLength * 2 + 1 chars.
+	 * @return The length of the hex string.
+	 */
+	size_t finishHex(Hasher *hasher, char *out);
+
+	/**
+	 * Hash the contents of a file, reading it in blocks.
+	 * @arg hasher The hasher to feed the file to.
+	 * @arg path The expanded path of the file.
+	 * @arg cancel If not NULL, checked between blocks.
+	 * @return False if the file couldn't be read or hashing was cancelled.
+	 */
+	bool hashFile(Hasher *hasher, const char *path, const std::atomic<bool> *cancel = NULL);
+}
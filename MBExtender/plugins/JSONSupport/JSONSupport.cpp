@@ -47,6 +47,7 @@ bool initPlugin(MBX::Plugin &plugin)
 {
 	MBX_INSTALL(plugin, ArrayObject);
 	MBX_INSTALL(plugin, JSONSupport);
+	MBX_INSTALL(plugin, JsonDocument);
 	MBX_INSTALL(plugin, RegexSupport);
 	return true;
 }
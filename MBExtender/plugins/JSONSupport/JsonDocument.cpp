@@ -0,0 +1,255 @@
+//-----------------------------------------------------------------------------
+// JsonDocument.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// JsonDocument keeps a parsed JSON tree in native memory and only turns the
+// parts that script actually asks for into strings or SimObjects. jsonParse()
+// creates a SimObject for every object and array in the input, which gets
+// expensive for large server responses where only a few fields are read.
+//
+// Paths are written like "scores[3].name" or "scores.3.name". An empty path
+// refers to the root of the document.
+
+#include <MBExtender/MBExtender.h>
+#include <MathLib/MathLib.h>
+#include <json/json.h>
+#include <string>
+#include <unordered_map>
+
+#include <TorqueLib/console/console.h>
+#include <TorqueLib/console/simBase.h>
+#include <TorqueLib/console/scriptObject.h>
+
+MBX_MODULE(JsonDocument);
+
+#define DEBUG_JSON_DOCUMENT 0
+
+const char *toString(Json::Value &value);
+char *copyToReturnBuffer(const std::string &string);
+
+std::unordered_map<SimObjectId, Json::Value *> gJsonDocuments;
+
+static Json::Value *resolveDocument(TGE::SimObject *object) {
+	std::unordered_map<SimObjectId, Json::Value *>::iterator it = gJsonDocuments.find(object->getId());
+	if (it == gJsonDocuments.end())
+		return NULL;
+	return it->second;
+}
+
+static bool parseDocument(const char *json, Json::Value &root) {
+	Json::CharReaderBuilder builder;
+	Json::CharReader *reader = builder.newCharReader();
+
+	std::string errs;
+	bool success = reader->parse(json, json + strlen(json), &root, &errs);
+	delete reader;
+
+	if (!success) {
+		TGE::Con::errorf("JSON Parse error: %s", errs.c_str());
+	}
+	return success;
+}
+
+/**
+ * Walk a path from the root of a document.
+ * @arg root The root value of the document.
+ * @arg path A path of the form "a.b[2].c". Array indices may also be written
+ *           as plain segments ("a.b.2.c").
+ * @return The value at the path, or NULL if any part of it does not exist.
+ */
+static const Json::Value *findPath(const Json::Value &root, const char *path) {
+	const Json::Value *current = &root;
+	const char *pos = path;
+
+	while (*pos != 0) {
+		//Skip separators, "a.b" and "a[0]" both just split the path
+		if (*pos == '.' || *pos == '[') {
+			pos++;
+			continue;
+		}
+
+		//Read until the end of this segment
+		const char *end = pos;
+		while (*end != 0 && *end != '.' && *end != '[' && *end != ']')
+			end++;
+
+		if (current->isObject()) {
+			current = current->find(pos, end);
+		} else if (current->isArray()) {
+			//Segment must be entirely made of digits to be an index
+			U32 index = 0;
+			for (const char *digit = pos; digit < end; digit++) {
+				if (*digit < '0' || *digit > '9')
+					return NULL;
+				index = index * 10 + (*digit - '0');
+			}
+			if (pos == end || index >= current->size())
+				return NULL;
+			current = &(*current)[index];
+		} else {
+			//Can't index into a scalar
+			return NULL;
+		}
+		if (current == NULL)
+			return NULL;
+
+		pos = end;
+		if (*pos == ']')
+			pos++;
+	}
+
+	return current;
+}
+
+static const char *getTypeName(const Json::Value &value) {
+	switch (value.type()) {
+		case Json::nullValue:    return "null";
+		case Json::intValue:     return "number";
+		case Json::uintValue:    return "number";
+		case Json::realValue:    return "number";
+		case Json::stringValue:  return "string";
+		case Json::booleanValue: return "bool";
+		case Json::arrayValue:   return "array";
+		case Json::objectValue:  return "object";
+		default:                 return "";
+	}
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(JsonDocument, S32, 2, 3, "JsonDocument(string json [, name]);") {
+	//Parse before creating the object, creating it clobbers argv
+	Json::Value *root = new Json::Value();
+	if (*argv[1] == 0 || !parseDocument(argv[1], *root)) {
+		delete root;
+		return 0;
+	}
+
+	TGE::ScriptObject *object = TGE::ScriptObject::create();
+	object->mClassName = "JsonDocument";
+	object->mFlags |= TGE::SimObject::ModDynamicFields | TGE::SimObject::ModStaticFields;
+	if (argc > 2) {
+		std::string name(argv[2]);
+		object->assignName(name.c_str());
+	}
+	object->registerObject();
+	TGE::SimObject *jsonGroup = TGE::Sim::findObject("JSONGroup");
+	if (jsonGroup) {
+		TGE::SimGroup *group = static_cast<TGE::SimGroup *>(jsonGroup);
+		group->addObject(object);
+	}
+
+	gJsonDocuments[object->getId()] = root;
+#if DEBUG_JSON_DOCUMENT
+	TGE::Con::printf("JsonDocument %d created", object->getId());
+#endif
+
+	return object->getId();
+}
+
+MBX_CONSOLE_METHOD_NAMED(JsonDocument, has, bool, 3, 3, "(path)") {
+	Json::Value *root = resolveDocument(object);
+	if (root == NULL) {
+		TGE::Con::errorf("JsonDocument::has: %s is not a valid document!", object->getIdString());
+		return false;
+	}
+	return findPath(*root, argv[2]) != NULL;
+}
+
+MBX_CONSOLE_METHOD_NAMED(JsonDocument, get, const char *, 3, 3, "(path)") {
+	Json::Value *root = resolveDocument(object);
+	if (root == NULL) {
+		TGE::Con::errorf("JsonDocument::get: %s is not a valid document!", object->getIdString());
+		return "";
+	}
+	const Json::Value *value = findPath(*root, argv[2]);
+	if (value == NULL)
+		return "";
+
+	//Objects and arrays are materialized the same way jsonParse() does it, but
+	// only for the subtree that was asked for
+	return toString(const_cast<Json::Value &>(*value));
+}
+
+MBX_CONSOLE_METHOD_NAMED(JsonDocument, count, S32, 3, 3, "(path)") {
+	Json::Value *root = resolveDocument(object);
+	if (root == NULL) {
+		TGE::Con::errorf("JsonDocument::count: %s is not a valid document!", object->getIdString());
+		return 0;
+	}
+	const Json::Value *value = findPath(*root, argv[2]);
+	if (value == NULL)
+		return 0;
+	if (!value->isArray() && !value->isObject())
+		return 0;
+	return value->size();
+}
+
+MBX_CONSOLE_METHOD_NAMED(JsonDocument, keys, const char *, 3, 3, "(path) Returns a tab-separated list of member names") {
+	Json::Value *root = resolveDocument(object);
+	if (root == NULL) {
+		TGE::Con::errorf("JsonDocument::keys: %s is not a valid document!", object->getIdString());
+		return "";
+	}
+	const Json::Value *value = findPath(*root, argv[2]);
+	if (value == NULL || !value->isObject())
+		return "";
+
+	std::string keys;
+	for (Json::ValueConstIterator it = value->begin(); it != value->end(); it++) {
+		if (!keys.empty())
+			keys += '\t';
+		keys += it.name();
+	}
+	return copyToReturnBuffer(keys);
+}
+
+MBX_CONSOLE_METHOD_NAMED(JsonDocument, typeOf, const char *, 3, 3, "(path) Returns null, number, string, bool, array, object, or \"\" if the path does not exist") {
+	Json::Value *root = resolveDocument(object);
+	if (root == NULL) {
+		TGE::Con::errorf("JsonDocument::typeOf: %s is not a valid document!", object->getIdString());
+		return "";
+	}
+	const Json::Value *value = findPath(*root, argv[2]);
+	if (value == NULL)
+		return "";
+	return getTypeName(*value);
+}
+
+//------------------------------------------------------------------------------
+// Memory
+//------------------------------------------------------------------------------
+
+MBX_OVERRIDE_MEMBERFN(void, TGE::SimObject::deleteObject, (TGE::SimObject *thisptr), originalDeleteObject) {
+	std::unordered_map<SimObjectId, Json::Value *>::iterator it = gJsonDocuments.find(thisptr->getId());
+	if (it != gJsonDocuments.end()) {
+#if DEBUG_JSON_DOCUMENT
+		TGE::Con::printf("JsonDocument %d deleted", thisptr->getId());
+#endif
+		delete it->second;
+		gJsonDocuments.erase(it);
+	}
+	originalDeleteObject(thisptr);
+}
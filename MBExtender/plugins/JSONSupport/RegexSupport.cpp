@@ -24,7 +24,10 @@
 
 #include <MBExtender/MBExtender.h>
 
+#include <list>
+#include <memory>
 #include <regex>
+#include <unordered_map>
 #include "arrayObject.h"
 #include <MathLib/MathLib.h>
 
@@ -40,44 +43,225 @@
 
 MBX_MODULE(RegexSupport);
 
-MBX_CONSOLE_FUNCTION(regexMatch, bool, 3, 4, "regexMatch(testString, pattern [, matches]);") {
-	std::string testString(argv[1]);
-	try {
-		std::regex regex(argv[2]);
-		if (argc > 3) {
-			ArrayObject *result = ArrayObject::resolve(StringMath::scan<SimObjectId>(argv[3]));
+// Compiling a std::regex is far more expensive than matching with one, and
+// script tends to run the same few patterns in loops. Compiled patterns are
+// kept in a small LRU cache keyed by flags and pattern, and script can also
+// hold on to a compiled pattern explicitly with regexCompile().
 
-			std::smatch matches;
-			bool found = std::regex_match(testString, matches, regex);
+typedef std::shared_ptr<const std::regex> RegexPtr;
 
-			for (const std::string &match : matches) {
-				result->addEntry(match);
-			}
+static U32 gRegexCacheSize = 64;
+static std::list<std::pair<std::string, RegexPtr>> gRegexCache;
+static std::unordered_map<std::string, std::list<std::pair<std::string, RegexPtr>>::iterator> gRegexCacheMap;
 
-			return found;
-		} else {
-			return std::regex_match(testString, regex);
+static std::unordered_map<S32, RegexPtr> gCompiledRegexes;
+static S32 gNextRegexHandle = 1;
+
+static std::regex::flag_type parseFlags(const char *flags) {
+	std::regex::flag_type result = std::regex::ECMAScript;
+	for (const char *ch = flags; *ch; ch ++) {
+		switch (*ch) {
+			case 'i': result |= std::regex::icase; break;
+			case 'o': result |= std::regex::optimize; break;
+			default: break;
 		}
-	} catch (std::regex_error e) {
+	}
+	return result;
+}
+
+/**
+ * Get a compiled regex from the cache, compiling it if necessary.
+ * @arg pattern The regex pattern.
+ * @arg flags A string of flag characters ("i" for case-insensitive).
+ * @return The compiled regex. Throws std::regex_error if the pattern is bad.
+ */
+static RegexPtr getRegex(const char *pattern, const char *flags) {
+	std::regex::flag_type flagBits = parseFlags(flags);
+
+	//Flags go first in the key so patterns can contain anything
+	std::string key = StringMath::print(static_cast<U32>(flagBits));
+	key += ':';
+	key += pattern;
+
+	auto found = gRegexCacheMap.find(key);
+	if (found != gRegexCacheMap.end()) {
+		//Move to the front so it's the last one evicted
+		gRegexCache.splice(gRegexCache.begin(), gRegexCache, found->second);
+		return found->second->second;
+	}
+
+	RegexPtr regex = std::make_shared<std::regex>(pattern, flagBits);
+	if (gRegexCacheSize == 0)
+		return regex;
+
+	gRegexCache.emplace_front(key, regex);
+	gRegexCacheMap[key] = gRegexCache.begin();
+	while (gRegexCache.size() > gRegexCacheSize) {
+		gRegexCacheMap.erase(gRegexCache.back().first);
+		gRegexCache.pop_back();
+	}
+	return regex;
+}
+
+static RegexPtr getCompiledRegex(const char *handle) {
+	auto found = gCompiledRegexes.find(StringMath::scan<S32>(handle));
+	if (found == gCompiledRegexes.end())
+		return RegexPtr();
+	return found->second;
+}
+
+static bool doMatch(const std::string &testString, const std::regex &regex, const char *matchesArray) {
+	if (*matchesArray == 0) {
+		return std::regex_match(testString, regex);
+	}
+
+	ArrayObject *result = ArrayObject::resolve(StringMath::scan<SimObjectId>(matchesArray));
+
+	std::smatch matches;
+	bool found = std::regex_match(testString, matches, regex);
+
+	if (result != NULL) {
+		for (const std::string &match : matches) {
+			result->addEntry(match);
+		}
+	}
+
+	return found;
+}
+
+static const char *doReplace(const std::string &testString, const std::regex &regex, const std::string &replacement) {
+	std::string replaced = std::regex_replace(testString, regex, replacement);
+	return copyToReturnBuffer(replaced);
+}
+
+//Every match is added to the array as one entry, with the whole match and each
+// capture group separated by tabs
+static S32 doMatchAll(const std::string &testString, const std::regex &regex, const char *matchesArray) {
+	ArrayObject *result = ArrayObject::resolve(StringMath::scan<SimObjectId>(matchesArray));
+
+	S32 count = 0;
+	std::string entry;
+	for (std::sregex_iterator it(testString.begin(), testString.end(), regex), end; it != end; ++ it) {
+		const std::smatch &match = *it;
+		if (result != NULL) {
+			entry.clear();
+			for (U32 i = 0; i < match.size(); i ++) {
+				if (i > 0)
+					entry += '\t';
+				entry += match[i].str();
+			}
+			result->addEntry(entry);
+		}
+		count ++;
+	}
+	return count;
+}
+
+MBX_CONSOLE_FUNCTION(regexMatch, bool, 3, 5, "regexMatch(testString, pattern [, matches [, flags]]);") {
+	std::string testString(argv[1]);
+	try {
+		RegexPtr regex = getRegex(argv[2], argc > 4 ? argv[4] : "");
+		return doMatch(testString, *regex, argc > 3 ? argv[3] : "");
+	} catch (const std::regex_error &e) {
 		TGE::Con::errorf("regexMatch: %s", e.what());
 		return false;
 	}
 }
 
-MBX_CONSOLE_FUNCTION(regexReplace, const char *, 4, 4, "regexMatch(testString, pattern, replacement);") {
+MBX_CONSOLE_FUNCTION(regexReplace, const char *, 4, 5, "regexReplace(testString, pattern, replacement [, flags]);") {
 	std::string testString(argv[1]);
 	std::string replacement(argv[3]);
 
 	try {
-		std::regex regex(argv[2]);
-		std::string replaced = std::regex_replace(testString, regex, replacement);
+		RegexPtr regex = getRegex(argv[2], argc > 4 ? argv[4] : "");
+		return doReplace(testString, *regex, replacement);
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexReplace: %s", e.what());
+		return argv[1];
+	}
+}
+
+MBX_CONSOLE_FUNCTION(regexMatchAll, S32, 4, 5, "regexMatchAll(testString, pattern, matches [, flags]); Returns the number of matches") {
+	std::string testString(argv[1]);
+	try {
+		RegexPtr regex = getRegex(argv[2], argc > 4 ? argv[4] : "");
+		return doMatchAll(testString, *regex, argv[3]);
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexMatchAll: %s", e.what());
+		return 0;
+	}
+}
 
-		char *ret = TGE::Con::getReturnBuffer(replaced.length() + 1);
-		strcpy(ret, replaced.data());
+MBX_CONSOLE_FUNCTION(regexSetCacheSize, void, 2, 2, "regexSetCacheSize(size);") {
+	gRegexCacheSize = StringMath::scan<U32>(argv[1]);
+	while (gRegexCache.size() > gRegexCacheSize) {
+		gRegexCacheMap.erase(gRegexCache.back().first);
+		gRegexCache.pop_back();
+	}
+}
 
-		return ret;
-	} catch (std::regex_error e) {
-		TGE::Con::errorf("regexReplace: %s", e.what());
+//------------------------------------------------------------------------------
+// Precompiled handles
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(regexCompile, S32, 2, 3, "regexCompile(pattern [, flags]); Returns a handle, or 0 if the pattern is invalid") {
+	try {
+		RegexPtr regex = getRegex(argv[1], argc > 2 ? argv[2] : "");
+		S32 handle = gNextRegexHandle ++;
+		gCompiledRegexes[handle] = regex;
+		return handle;
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexCompile: %s", e.what());
+		return 0;
+	}
+}
+
+MBX_CONSOLE_FUNCTION(regexFree, void, 2, 2, "regexFree(handle);") {
+	gCompiledRegexes.erase(StringMath::scan<S32>(argv[1]));
+}
+
+MBX_CONSOLE_FUNCTION(regexMatchCompiled, bool, 3, 4, "regexMatchCompiled(testString, handle [, matches]);") {
+	RegexPtr regex = getCompiledRegex(argv[2]);
+	if (!regex) {
+		TGE::Con::errorf("regexMatchCompiled: invalid handle %s", argv[2]);
+		return false;
+	}
+	std::string testString(argv[1]);
+	try {
+		return doMatch(testString, *regex, argc > 3 ? argv[3] : "");
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexMatchCompiled: %s", e.what());
+		return false;
+	}
+}
+
+MBX_CONSOLE_FUNCTION(regexReplaceCompiled, const char *, 4, 4, "regexReplaceCompiled(testString, handle, replacement);") {
+	RegexPtr regex = getCompiledRegex(argv[2]);
+	if (!regex) {
+		TGE::Con::errorf("regexReplaceCompiled: invalid handle %s", argv[2]);
+		return argv[1];
+	}
+	std::string testString(argv[1]);
+	std::string replacement(argv[3]);
+	try {
+		return doReplace(testString, *regex, replacement);
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexReplaceCompiled: %s", e.what());
 		return argv[1];
 	}
 }
+
+MBX_CONSOLE_FUNCTION(regexMatchAllCompiled, S32, 4, 4, "regexMatchAllCompiled(testString, handle, matches); Returns the number of matches") {
+	RegexPtr regex = getCompiledRegex(argv[2]);
+	if (!regex) {
+		TGE::Con::errorf("regexMatchAllCompiled: invalid handle %s", argv[2]);
+		return 0;
+	}
+	std::string testString(argv[1]);
+	try {
+		return doMatchAll(testString, *regex, argv[3]);
+	} catch (const std::regex_error &e) {
+		TGE::Con::errorf("regexMatchAllCompiled: %s", e.what());
+		return 0;
+	}
+}
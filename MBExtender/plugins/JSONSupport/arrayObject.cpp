@@ -42,8 +42,17 @@ std::unordered_map<S32, ArrayObject *> gArrayObjects;
 // Array struct methods
 //------------------------------------------------------------------------------
 
+ArrayObject::ArrayObject() : mObjectId(0), mIndexed(false), mFirstIndexDirty(false) {
+}
+
 void ArrayObject::addEntry(const Entry &entry) {
 	val.push_back(entry);
+	if (mIndexed) {
+		indexAdd(entry);
+		//Appending can't move anything, so only a brand new entry needs a position
+		if (!mFirstIndexDirty && mFirstIndex.find(entry) == mFirstIndex.end())
+			mFirstIndex[entry] = val.size() - 1;
+	}
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d add %s", mObjectId, entry.c_str());
 #endif
@@ -51,6 +60,11 @@ void ArrayObject::addEntry(const Entry &entry) {
 void ArrayObject::replaceEntry(U32 index, const Entry &newEntry) {
 	if (index >= val.size())
 		return;
+	if (mIndexed) {
+		indexRemove(val[index]);
+		indexAdd(newEntry);
+		mFirstIndexDirty = true;
+	}
 	val[index] = newEntry;
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d replace index %d with %s", mObjectId, index, newEntry.c_str());
@@ -60,6 +74,10 @@ void ArrayObject::insertEntryBefore(U32 index, const Entry &entry) {
 	if (index > val.size())
 		return;
 	val.insert(val.begin() + index, entry);
+	if (mIndexed) {
+		indexAdd(entry);
+		mFirstIndexDirty = true;
+	}
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d insert before %d with %s", mObjectId, index, entry.c_str());
 #endif
@@ -67,14 +85,24 @@ void ArrayObject::insertEntryBefore(U32 index, const Entry &entry) {
 void ArrayObject::removeEntry(U32 index) {
 	if (index >= val.size())
 		return;
+	if (mIndexed) {
+		indexRemove(val[index]);
+		mFirstIndexDirty = true;
+	}
 	val.erase(val.begin() + index);
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d remove %d", mObjectId, index);
 #endif
 }
 void ArrayObject::removeMatching(const Entry &match) {
+	if (mIndexed && mCounts.find(match) == mCounts.end())
+		return;
 	std::vector<Entry>::iterator it = std::find(val.begin(), val.end(), match);
 	if (it != val.end()) {
+		if (mIndexed) {
+			indexRemove(match);
+			mFirstIndexDirty = true;
+		}
 		val.erase(it);
 #if DEBUG_ARRAY
 		TGE::Con::printf("Array %d remove matching %s", mObjectId, match.c_str());
@@ -83,6 +111,9 @@ void ArrayObject::removeMatching(const Entry &match) {
 }
 void ArrayObject::clear() {
 	val.clear();
+	mCounts.clear();
+	mFirstIndex.clear();
+	mFirstIndexDirty = false;
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d clear");
 #endif
@@ -90,6 +121,7 @@ void ArrayObject::clear() {
 }
 void ArrayObject::swap(U32 index1, U32 index2) {
 	std::swap(val[index1], val[index2]);
+	mFirstIndexDirty = true;
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d swap %d and %d", mObjectId, index1, index2);
 #endif
@@ -108,34 +140,84 @@ struct ScriptCompare {
 	}
 };
 
-void ArrayObject::sort(const char *scriptFunc) {
+void ArrayObject::sort(const char *scriptFunc, bool stable) {
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d sorting...", mObjectId);
 #endif
-	sort(ScriptCompare(scriptFunc));
+	sort(ScriptCompare(scriptFunc), stable);
 }
 
-struct NumericCompare {
-	bool operator()(const std::string &a, const std::string &b) const {
-		bool result = StringMath::scan<F32>(a.c_str()) < StringMath::scan<F32>(b.c_str());
-#if DEBUG_ARRAY
-		TGE::Con::printf("Array sort %s and %s returned %s", a.c_str(), b.c_str(), (result ? "true" : "false"));
-#endif
-		return result;
+/**
+ * Sort key for decorate-sort-undecorate sorting. Keys are computed once per
+ * entry instead of once per comparison, and the entries are moved into place
+ * after the keys are sorted.
+ */
+template<typename K>
+struct SortKey {
+	K key;
+	U32 index;
+
+	bool operator<(const SortKey<K> &other) const {
+		return key < other.key;
 	}
 };
+
+template<typename K>
+static void applySortKeys(std::vector<ArrayObject::Entry> &val, std::vector<SortKey<K>> &keys, bool stable) {
+	if (stable) {
+		std::stable_sort(keys.begin(), keys.end());
+	} else {
+		std::sort(keys.begin(), keys.end());
+	}
+
+	std::vector<ArrayObject::Entry> sorted;
+	sorted.reserve(val.size());
+	for (U32 i = 0; i < keys.size(); i ++) {
+		sorted.push_back(std::move(val[keys[i].index]));
+	}
+	val.swap(sorted);
+}
+
 //Default sort is numerical
-void ArrayObject::sort() {
+void ArrayObject::sort(bool stable) {
 #if DEBUG_ARRAY
 	TGE::Con::printf("Array %d sorting...", mObjectId);
 #endif
-	sort(NumericCompare());
+	std::vector<SortKey<F32>> keys(val.size());
+	for (U32 i = 0; i < val.size(); i ++) {
+		keys[i].key = StringMath::scan<F32>(val[i].c_str());
+		keys[i].index = i;
+	}
+	applySortKeys(val, keys, stable);
+	mFirstIndexDirty = true;
 }
 
-const ArrayObject::Entry &ArrayObject::getEntry(U32 index) const {
-	return val[index];
+//Call the script function once per entry to get its key, then sort by those.
+// Always stable so equal keys keep their order.
+void ArrayObject::sortByKey(const char *scriptFunc, bool numeric) {
+#if DEBUG_ARRAY
+	TGE::Con::printf("Array %d sorting by key...", mObjectId);
+#endif
+	std::string func(scriptFunc);
+	if (numeric) {
+		std::vector<SortKey<F32>> keys(val.size());
+		for (U32 i = 0; i < val.size(); i ++) {
+			keys[i].key = StringMath::scan<F32>(TGE::Con::executef(2, func.c_str(), val[i].c_str()));
+			keys[i].index = i;
+		}
+		applySortKeys(val, keys, true);
+	} else {
+		std::vector<SortKey<std::string>> keys(val.size());
+		for (U32 i = 0; i < val.size(); i ++) {
+			keys[i].key = TGE::Con::executef(2, func.c_str(), val[i].c_str());
+			keys[i].index = i;
+		}
+		applySortKeys(val, keys, true);
+	}
+	mFirstIndexDirty = true;
 }
-ArrayObject::Entry &ArrayObject::getEntry(U32 index) {
+
+const ArrayObject::Entry &ArrayObject::getEntry(U32 index) const {
 	return val[index];
 }
 S32 ArrayObject::getSize() const {
@@ -143,10 +225,71 @@ S32 ArrayObject::getSize() const {
 }
 
 bool ArrayObject::contains(const Entry &match) const {
+	if (mIndexed) {
+		return mCounts.find(match) != mCounts.end();
+	}
 	std::vector<Entry>::const_iterator it = std::find(val.begin(), val.end(), match);
 	return it != val.end();
 }
 
+S32 ArrayObject::indexOf(const Entry &match) {
+	if (mIndexed) {
+		if (mCounts.find(match) == mCounts.end())
+			return -1;
+		if (mFirstIndexDirty)
+			rebuildFirstIndex();
+		return mFirstIndex[match];
+	}
+	std::vector<Entry>::const_iterator it = std::find(val.begin(), val.end(), match);
+	if (it == val.end())
+		return -1;
+	return it - val.begin();
+}
+
+//------------------------------------------------------------------------------
+// Hash index
+//------------------------------------------------------------------------------
+
+void ArrayObject::setIndexed(bool indexed) {
+	if (indexed == mIndexed)
+		return;
+	mIndexed = indexed;
+	mCounts.clear();
+	mFirstIndex.clear();
+	if (indexed) {
+		for (U32 i = 0; i < val.size(); i ++) {
+			indexAdd(val[i]);
+		}
+		rebuildFirstIndex();
+	}
+}
+bool ArrayObject::isIndexed() const {
+	return mIndexed;
+}
+
+void ArrayObject::indexAdd(const Entry &entry) {
+	mCounts[entry] ++;
+}
+void ArrayObject::indexRemove(const Entry &entry) {
+	std::unordered_map<Entry, U32>::iterator it = mCounts.find(entry);
+	if (it == mCounts.end())
+		return;
+	if (-- it->second == 0) {
+		mCounts.erase(it);
+		mFirstIndex.erase(entry);
+	}
+}
+
+//Positions shift whenever something is inserted, removed or moved, so they are
+// recomputed in one pass the next time indexOf() needs them
+void ArrayObject::rebuildFirstIndex() {
+	mFirstIndex.clear();
+	for (U32 i = val.size(); i > 0; i --) {
+		mFirstIndex[val[i - 1]] = i - 1;
+	}
+	mFirstIndexDirty = false;
+}
+
 //------------------------------------------------------------------------------
 // Console functions
 //------------------------------------------------------------------------------
@@ -250,17 +393,27 @@ MBX_CONSOLE_METHOD_NAMED(Array, swap, S32, 4, 4, "(%index1, %index2)") {
 	array->swap(StringMath::scan<U32>(argv[2]), StringMath::scan<U32>(argv[3]));
 	return object->getId();
 }
-MBX_CONSOLE_METHOD_NAMED(Array, sort, S32, 2, 3, "(%compareFn)") {
+MBX_CONSOLE_METHOD_NAMED(Array, sort, S32, 2, 4, "([%compareFn, %stable])") {
 	ArrayObject *array = ArrayObject::resolve(object);
 	if (array == NULL) {
 		TGE::Con::errorf("Array::sort: %s passed an invalid array!", object->mName);
 		return object->getId();
 	}
-	if (argc == 2) {
-		array->sort();
+	bool stable = (argc > 3 ? StringMath::scan<bool>(argv[3]) : false);
+	if (argc == 2 || *argv[2] == 0) {
+		array->sort(stable);
 	} else {
-		array->sort(argv[2]);
+		array->sort(argv[2], stable);
+	}
+	return object->getId();
+}
+MBX_CONSOLE_METHOD_NAMED(Array, sortByKey, S32, 3, 4, "(%keyFn[, %numeric]) Sort by the value of %keyFn(%entry), called once per entry") {
+	ArrayObject *array = ArrayObject::resolve(object);
+	if (array == NULL) {
+		TGE::Con::errorf("Array::sortByKey: %s passed an invalid array!", object->mName);
+		return object->getId();
 	}
+	array->sortByKey(argv[2], argc > 3 ? StringMath::scan<bool>(argv[3]) : false);
 	return object->getId();
 }
 
@@ -320,6 +473,32 @@ MBX_CONSOLE_METHOD_NAMED(Array, contains, bool, 3, 3, "(%entry)") {
 	return array->contains(argv[2]);
 }
 
+MBX_CONSOLE_METHOD_NAMED(Array, indexOf, S32, 3, 3, "(%entry) Returns the first index of %entry, or -1") {
+	ArrayObject *array = ArrayObject::resolve(object);
+	if (array == NULL) {
+		TGE::Con::errorf("Array::indexOf: %s passed an invalid array!", object->mName);
+		return -1;
+	}
+	return array->indexOf(argv[2]);
+}
+MBX_CONSOLE_METHOD_NAMED(Array, setIndexed, S32, 3, 3, "(%indexed) Keep a hash index for contains() and indexOf()") {
+	ArrayObject *array = ArrayObject::resolve(object);
+	if (array == NULL) {
+		TGE::Con::errorf("Array::setIndexed: %s passed an invalid array!", object->mName);
+		return object->getId();
+	}
+	array->setIndexed(StringMath::scan<bool>(argv[2]));
+	return object->getId();
+}
+MBX_CONSOLE_METHOD_NAMED(Array, isIndexed, bool, 2, 2, "()") {
+	ArrayObject *array = ArrayObject::resolve(object);
+	if (array == NULL) {
+		TGE::Con::errorf("Array::isIndexed: %s passed an invalid array!", object->mName);
+		return false;
+	}
+	return array->isIndexed();
+}
+
 //------------------------------------------------------------------------------
 // Debugging
 //------------------------------------------------------------------------------
@@ -25,6 +25,8 @@
 #include <TorqueLib/platform/platform.h>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <algorithm>
 
 namespace TGE {
 	class SimObject;
@@ -37,7 +39,19 @@ protected:
 	std::vector<Entry> val;
 	S32 mObjectId;
 
+	//Optional hash index, see setIndexed()
+	bool mIndexed;
+	bool mFirstIndexDirty;
+	std::unordered_map<Entry, U32> mCounts;
+	std::unordered_map<Entry, U32> mFirstIndex;
+
+	void indexAdd(const Entry &entry);
+	void indexRemove(const Entry &entry);
+	void rebuildFirstIndex();
+
 public:
+	ArrayObject();
+
 	static TGE::SimObject *create(const char *name = "");
 	static ArrayObject *resolve(TGE::SimObject *object);
 	static ArrayObject *resolve(SimObjectId objectId);
@@ -52,23 +66,34 @@ public:
 	void swap(U32 index1, U32 index2);
 
 	template<typename T>
-	void sort(const T &compare);
+	void sort(const T &compare, bool stable = false);
 
-	void sort(const char *scriptFunc);
-	void sort();
+	void sort(const char *scriptFunc, bool stable = false);
+	void sort(bool stable = false);
+	void sortByKey(const char *scriptFunc, bool numeric);
 
 	//Retrieving data
 	const Entry &getEntry(U32 index) const;
-	Entry &getEntry(U32 index);
 	S32 getSize() const;
 
 	//Checking if an entry exists
 	bool contains(const Entry &match) const;
+	S32 indexOf(const Entry &match);
+
+	//Keep a hash index of entries so contains() and indexOf() don't have to
+	// scan the whole array
+	void setIndexed(bool indexed);
+	bool isIndexed() const;
 };
 
 char *copyToReturnBuffer(const std::string &string);
 
 template<typename T>
-inline void ArrayObject::sort(const T &compare) {
-	std::sort(val.begin(), val.end(), compare);
+inline void ArrayObject::sort(const T &compare, bool stable) {
+	if (stable) {
+		std::stable_sort(val.begin(), val.end(), compare);
+	} else {
+		std::sort(val.begin(), val.end(), compare);
+	}
+	mFirstIndexDirty = true;
 }
@@ -66,11 +66,141 @@ static U32 gActiveVirtualMap = 0;
 
 static std::vector<std::unordered_map<S32, TGE::JoystickCodes> > gJoystickMaps;
 
+//Axis values closer to zero than this are reported as zero
+static S16 gDeadzone = 0;
+//Minimum time between move events for a single axis, 0 for no limit
+static U32 gAxisIntervalMs = 0;
+
+/**
+ * An opened controller. Controllers are opened once when SDL reports them
+ * and stay open until they are unplugged. Slots are reused so a controller's
+ * deviceInst doesn't change when another one is unplugged.
+ */
+struct Controller {
+	SDL_GameController *controller;
+	SDL_Joystick *joystick;
+	SDL_JoystickID instanceId;
+
+	//Per-axis state, indexed by SDL axis number
+	std::vector<TGE::JoystickCodes> axisMap;
+	std::vector<S16> axisStates;
+	std::vector<S16> axisPending;
+	std::vector<U32> axisLastPost;
+
+	std::vector<bool> hatStates;
+	S32 buttonCount;
+
+	bool isOpen() const { return joystick != NULL; }
+};
+
+static std::vector<Controller> gControllers;
+
 #ifdef _WIN32
 extern "C" SDL_bool SDL_XINPUT_Enabled(void);
 bool gSupportXInput;
 #endif
 
+/**
+ * Resolve the virtual axis for each real axis of a controller using the
+ * active map, so the event loop doesn't need any hash lookups.
+ */
+static void updateAxisMap(Controller &controller) {
+	const std::unordered_map<S32, TGE::JoystickCodes> &map = gJoystickMaps[gActiveVirtualMap];
+	for (U32 axis = 0; axis < controller.axisMap.size(); axis ++) {
+		std::unordered_map<S32, TGE::JoystickCodes>::const_iterator found = map.find(axis);
+		controller.axisMap[axis] = (found == map.end() ? (TGE::JoystickCodes)(axis + TGE::SI_XAXIS) : found->second);
+	}
+}
+
+static void updateAllAxisMaps() {
+	for (U32 i = 0; i < gControllers.size(); i ++) {
+		if (gControllers[i].isOpen()) {
+			updateAxisMap(gControllers[i]);
+		}
+	}
+}
+
+static S32 findController(SDL_JoystickID instanceId) {
+	for (U32 i = 0; i < gControllers.size(); i ++) {
+		if (gControllers[i].isOpen() && gControllers[i].instanceId == instanceId)
+			return i;
+	}
+	return -1;
+}
+
+static void openController(S32 deviceIndex) {
+	SDL_GameController *cont = NULL;
+	SDL_Joystick *joystick;
+	if (SDL_IsGameController(deviceIndex)) {
+		cont = SDL_GameControllerOpen(deviceIndex);
+	}
+	if (cont == NULL) {
+		joystick = SDL_JoystickOpen(deviceIndex);
+	} else {
+		joystick = SDL_GameControllerGetJoystick(cont);
+	}
+
+	if (joystick == NULL) {
+		TGE::Con::errorf("Controller error: %s", SDL_GetError());
+		return;
+	}
+
+	//Already open (SDL can report devices twice at startup)
+	SDL_JoystickID instanceId = SDL_JoystickInstanceID(joystick);
+	if (findController(instanceId) != -1) {
+		if (cont != NULL)
+			SDL_GameControllerClose(cont);
+		else
+			SDL_JoystickClose(joystick);
+		return;
+	}
+
+	//Reuse the first free slot
+	U32 slot = 0;
+	while (slot < gControllers.size() && gControllers[slot].isOpen())
+		slot ++;
+	if (slot == gControllers.size())
+		gControllers.push_back(Controller());
+
+	Controller &controller = gControllers[slot];
+	controller.controller = cont;
+	controller.joystick = joystick;
+	controller.instanceId = instanceId;
+
+	S32 axisCount = SDL_JoystickNumAxes(joystick);
+	controller.axisMap.assign(axisCount, TGE::SI_XAXIS);
+	controller.axisStates.assign(axisCount, 0);
+	controller.axisPending.assign(axisCount, 0);
+	controller.axisLastPost.assign(axisCount, 0);
+	controller.hatStates.assign(SDL_JoystickNumHats(joystick) * HAT_BUTTON_COUNT, false);
+	controller.buttonCount = SDL_JoystickNumButtons(joystick);
+	updateAxisMap(controller);
+
+	TGE::Con::printf("Controller %d connected: %s", slot, SDL_JoystickName(joystick));
+}
+
+static void closeController(SDL_JoystickID instanceId) {
+	S32 slot = findController(instanceId);
+	if (slot == -1)
+		return;
+
+	Controller &controller = gControllers[slot];
+	if (controller.controller != NULL)
+		SDL_GameControllerClose(controller.controller);
+	else
+		SDL_JoystickClose(controller.joystick);
+	controller.controller = NULL;
+	controller.joystick = NULL;
+
+	TGE::Con::printf("Controller %d disconnected", slot);
+}
+
+static SDL_Joystick *getJoystick(S32 slot) {
+	if (slot < 0 || slot >= static_cast<S32>(gControllers.size()))
+		return NULL;
+	return gControllers[slot].joystick;
+}
+
 bool initPlugin(MBX::Plugin &plugin)
 {
 	MBX_INSTALL(plugin, JoystickSupport);
@@ -97,9 +227,18 @@ bool initPlugin(MBX::Plugin &plugin)
 	TGE::Con::setVariable("Input::XInput", "0");
 #endif
 
-	SDL_JoystickUpdate();
+	//Input comes from the event queue, and the game controller events would
+	// just duplicate the joystick ones
+	SDL_JoystickEventState(SDL_ENABLE);
+	SDL_GameControllerEventState(SDL_IGNORE);
 
 	gJoystickMaps.push_back(std::unordered_map<S32, TGE::JoystickCodes>());
+
+	//Devices that are already plugged in are opened here. Anything plugged in
+	// later comes through SDL_JOYDEVICEADDED.
+	for (S32 i = 0; i < SDL_NumJoysticks(); i ++) {
+		openController(i);
+	}
 	return true;
 }
 
@@ -109,10 +248,15 @@ MBX_CONSOLE_FUNCTION(joystickAddMap, S32, 1, 1, "joystickAddMap()") {
 }
 
 MBX_CONSOLE_FUNCTION(joystickMapSetAxis, void, 4, 4, "joystickMapSetAxis(S32 mapId, S32 realAxis, const char *virtualAxis)") {
-	S32 mapId = StringMath::scan<S32>(argv[1]);
+	U32 mapId = StringMath::scan<U32>(argv[1]);
 	S32 realAxis = StringMath::scan<S32>(argv[2]);
 	const char *virtAxis = argv[3];
 
+	if (mapId >= gJoystickMaps.size()) {
+		TGE::Con::errorf("joystickMapSetAxis: Invalid map %d", mapId);
+		return;
+	}
+
 	TGE::JoystickCodes virtualAxis = TGE::SI_XAXIS;
 	for (U32 i = 0; i < sizeof(gVirtualAxes) / sizeof(const char *); i ++) {
 		if (strcasecmp(gVirtualAxes[i], virtAxis) == 0) {
@@ -122,30 +266,40 @@ MBX_CONSOLE_FUNCTION(joystickMapSetAxis, void, 4, 4, "joystickMapSetAxis(S32 map
 	}
 
 	gJoystickMaps[mapId][realAxis] = virtualAxis;
+	if (mapId == gActiveVirtualMap) {
+		updateAllAxisMaps();
+	}
 }
 
 MBX_CONSOLE_FUNCTION(joystickMapActivate, void, 2, 2, "joystickMapActivate(S32 mapId)") {
-	gActiveVirtualMap = StringMath::scan<S32>(argv[1]);
+	U32 mapId = StringMath::scan<U32>(argv[1]);
+	if (mapId >= gJoystickMaps.size()) {
+		TGE::Con::errorf("joystickMapActivate: Invalid map %d", mapId);
+		return;
+	}
+	gActiveVirtualMap = mapId;
+	updateAllAxisMaps();
+}
+
+MBX_CONSOLE_FUNCTION(joystickSetDeadzone, void, 2, 2, "joystickSetDeadzone(F32 deadzone) - Axis values within this fraction of center are reported as zero") {
+	F32 deadzone = mClampF(StringMath::scan<F32>(argv[1]), 0.0f, 1.0f);
+	gDeadzone = static_cast<S16>(deadzone * 32767.0f);
+}
+
+MBX_CONSOLE_FUNCTION(joystickSetAxisRate, void, 2, 2, "joystickSetAxisRate(U32 eventsPerSecond) - Limit how often each axis posts move events, 0 for no limit") {
+	U32 rate = StringMath::scan<U32>(argv[1]);
+	gAxisIntervalMs = (rate == 0 ? 0 : 1000 / rate);
 }
 
 MBX_CONSOLE_FUNCTION(dumpControllers, void, 1, 1, "") {
 	TGE::Con::printf("Detected %d Controllers", SDL_NumJoysticks());
 
-	for (S32 i = 0; i < SDL_NumJoysticks(); i ++) {
-		SDL_GameController *cont = SDL_GameControllerOpen(i);
-		SDL_Joystick *joystick;
-		if (cont == NULL) {
-			joystick = SDL_JoystickOpen(i);
-		} else {
-			joystick = SDL_GameControllerGetJoystick(cont);
-		}
-
-		if (joystick == NULL) {
-			TGE::Con::errorf("Controller error: %s", SDL_GetError());
+	for (U32 i = 0; i < gControllers.size(); i ++) {
+		SDL_Joystick *joystick = gControllers[i].joystick;
+		if (joystick == NULL)
 			continue;
-		}
 
-		TGE::Con::printf("Controller %d:", i);
+		TGE::Con::printf("Controller %d: %s", i, SDL_JoystickName(joystick));
 		TGE::Con::printf("   %d Buttons", SDL_JoystickNumButtons(joystick));
 		TGE::Con::printf("   %d Axes", SDL_JoystickNumAxes(joystick));
 		TGE::Con::printf("   %d Hats", SDL_JoystickNumHats(joystick));
@@ -157,151 +311,145 @@ MBX_CONSOLE_FUNCTION(dumpControllers, void, 1, 1, "") {
 	}
 }
 
-// TimeManager::process() override for using a higher-resolution timer
-MBX_OVERRIDE_FN(void, TGE::TimeManager::process, (), originalProcess) {
-	originalProcess();
-
-	if (gJoystick) {
-		SDL_JoystickUpdate();
-
-		//If you have more than one joystick plugged into your Mac I will be amazed.
-		for (int i = 0; i < SDL_NumJoysticks(); i ++) {
-			SDL_GameController *cont = SDL_GameControllerOpen(i);
-			SDL_Joystick *joystick;
-			if (cont == NULL) {
-				joystick = SDL_JoystickOpen(i);
-			} else {
-				joystick = SDL_GameControllerGetJoystick(cont);
-			}
-
-			if (joystick == NULL) {
-				TGE::Con::errorf("Controller error: %s", SDL_GetError());
-				continue;
-			}
-
-			static std::unordered_map<int, std::vector<short> > gAxisStates;
-			if (gAxisStates.find(i) == gAxisStates.end()) {
-				gAxisStates[i] = std::vector<short>(SDL_JoystickNumAxes(joystick));
-			}
-
-			//Axes (thumbsticks and side triggers)
-			for (int axis = 0; axis < SDL_JoystickNumAxes(joystick); axis ++) {
-				short value = SDL_JoystickGetAxis(joystick, axis);
-
-				TGE::JoystickCodes virtAxis = (gJoystickMaps[gActiveVirtualMap].find(axis) == gJoystickMaps[gActiveVirtualMap].end() ? (TGE::JoystickCodes)(axis + TGE::SI_XAXIS) : gJoystickMaps[gActiveVirtualMap][axis]);
-
-				//Make sure we have room for this axis
-				if (axis >= static_cast<S32>(gAxisStates[i].size())) {
-					gAxisStates[i].push_back(value);
-				}
+static void postButtonEvent(S32 slot, S32 button, bool pressed) {
+	TGE::InputEvent event;
+	event.deviceType = TGE::JoystickDeviceType;
+	//Joystick number, probably
+	event.deviceInst = slot;
+	//This is a button event
+	event.objType = SI_BUTTON;
+	//Button # offset from 0
+	event.objInst = TGE::KEY_BUTTON0 + button;
+	//MAKE for pressed, BREAK for unpress
+	event.action = (pressed ? SI_MAKE : SI_BREAK);
+	//1.0f for MAKE, 0.0f for BREAK
+	event.fValue = (pressed ? 1.0f : 0.0f);
+
+	TGE::Game->postEvent(event);
+}
 
-				//If we have a difference, push an event
-				if (value != gAxisStates[i][axis]) {
-					TGE::InputEvent event;
-					event.deviceType = TGE::JoystickDeviceType;
-					//Joystick number, probably
-					event.deviceInst = i;
-					//X Y Z RX RY RZ
-					//This order works for the wired xbox 360 controller
-					//Everything else untested
-					event.objType = virtAxis;
-					//[whatever]Axis #0
-					event.objInst = 0;
-					//Axes use MOVE actions
-					event.action = SI_MOVE;
-					//Normalize value to [-1.0f, 1.0f]
-					event.fValue = float(value) / 32768.0f;
-
-					TGE::Game->postEvent(event);
-				}
+static void postAxisEvent(S32 slot, Controller &controller, S32 axis, S16 value, U32 time) {
+	TGE::InputEvent event;
+	event.deviceType = TGE::JoystickDeviceType;
+	//Joystick number, probably
+	event.deviceInst = slot;
+	//X Y Z RX RY RZ
+	//This order works for the wired xbox 360 controller
+	//Everything else untested
+	event.objType = controller.axisMap[axis];
+	//[whatever]Axis #0
+	event.objInst = 0;
+	//Axes use MOVE actions
+	event.action = SI_MOVE;
+	//Normalize value to [-1.0f, 1.0f]
+	event.fValue = float(value) / 32768.0f;
+
+	TGE::Game->postEvent(event);
+
+	controller.axisStates[axis] = value;
+	controller.axisLastPost[axis] = time;
+}
 
-				//Now update state
-				gAxisStates[i][axis] = value;
-			}
+static void handleAxis(const SDL_JoyAxisEvent &axisEvent, U32 time) {
+	S32 slot = findController(axisEvent.which);
+	if (slot == -1)
+		return;
+	Controller &controller = gControllers[slot];
+	if (axisEvent.axis >= controller.axisStates.size())
+		return;
+
+	S16 value = axisEvent.value;
+	if (value > -gDeadzone && value < gDeadzone)
+		value = 0;
+
+	//Rate limited axes keep the newest value and post it once the interval
+	// has passed, see flushPendingAxes()
+	controller.axisPending[axisEvent.axis] = value;
+	if (value == controller.axisStates[axisEvent.axis])
+		return;
+	if (gAxisIntervalMs != 0 && time - controller.axisLastPost[axisEvent.axis] < gAxisIntervalMs)
+		return;
+
+	postAxisEvent(slot, controller, axisEvent.axis, value, time);
+}
 
-			static std::unordered_map<int, std::vector<bool> > gButtonStates;
-			if (gButtonStates.find(i) == gButtonStates.end()) {
-				gButtonStates[i] = std::vector<bool>(SDL_JoystickNumButtons(joystick));
+static void flushPendingAxes(U32 time) {
+	for (U32 slot = 0; slot < gControllers.size(); slot ++) {
+		Controller &controller = gControllers[slot];
+		if (!controller.isOpen())
+			continue;
+		for (U32 axis = 0; axis < controller.axisPending.size(); axis ++) {
+			if (controller.axisPending[axis] != controller.axisStates[axis] &&
+			    time - controller.axisLastPost[axis] >= gAxisIntervalMs) {
+				postAxisEvent(slot, controller, axis, controller.axisPending[axis], time);
 			}
+		}
+	}
+}
 
-			S32 buttonCount = SDL_JoystickNumButtons(joystick);
-			for (int button = 0; button < buttonCount; button ++) {
-				bool pressed = SDL_JoystickGetButton(joystick, button);
-
-				//Make sure we have room for this button
-				if (button >= static_cast<S32>(gButtonStates[i].size())) {
-					gButtonStates[i].push_back(pressed);
-				}
-
-				//If we have a difference, push an event
-				if (pressed != gButtonStates[i][button]) {
-					TGE::InputEvent event;
-					event.deviceType = TGE::JoystickDeviceType;
-					//Joystick number, probably
-					event.deviceInst = i;
-					//This is a button event
-					event.objType = SI_BUTTON;
-					//Button # offset from 0
-					event.objInst = TGE::KEY_BUTTON0 + button;
-					//MAKE for pressed, BREAK for unpress
-					event.action = (pressed ? SI_MAKE : SI_BREAK);
-					//1.0f for MAKE, 0.0f for BREAK
-					event.fValue = (pressed ? 1.0f : 0.0f);
-
-					TGE::Game->postEvent(event);
-				}
-
-				//Now update state
-				gButtonStates[i][button] = pressed;
-			}
+static void handleHat(const SDL_JoyHatEvent &hatEvent) {
+	S32 slot = findController(hatEvent.which);
+	if (slot == -1)
+		return;
+	Controller &controller = gControllers[slot];
+	U32 first = hatEvent.hat * HAT_BUTTON_COUNT;
+	if (first + HAT_BUTTON_COUNT > controller.hatStates.size())
+		return;
+
+	bool state[HAT_BUTTON_COUNT] = {
+		static_cast<bool>((hatEvent.value & SDL_HAT_UP)),
+		static_cast<bool>((hatEvent.value & SDL_HAT_DOWN)),
+		static_cast<bool>((hatEvent.value & SDL_HAT_LEFT)),
+		static_cast<bool>((hatEvent.value & SDL_HAT_RIGHT))
+	};
+
+	//Hats show up as 4 extra buttons after the real ones
+	for (int direction = 0; direction < HAT_BUTTON_COUNT; direction ++) {
+		if (controller.hatStates[first + direction] != state[direction]) {
+			postButtonEvent(slot, controller.buttonCount + first + direction, state[direction]);
+			controller.hatStates[first + direction] = state[direction];
+		}
+	}
+}
 
-			static std::unordered_map<int, std::vector<std::vector<bool> > > gHatStates;
-			if (gHatStates.find(i) == gHatStates.end()) {
-				gHatStates[i] = std::vector<std::vector<bool> >();
-			}
+// TimeManager::process() override for using a higher-resolution timer
+MBX_OVERRIDE_FN(void, TGE::TimeManager::process, (), originalProcess) {
+	originalProcess();
 
-			for (int hat = 0; hat < SDL_JoystickNumHats(joystick); hat ++) {
-				if (static_cast<S32>(gHatStates[i].size()) <= hat) {
-					gHatStates[i].push_back(std::vector<bool>(HAT_BUTTON_COUNT));
-				}
-				U16 buttonIndices[HAT_BUTTON_COUNT] = {
-					static_cast<U16>(buttonCount + (hat * HAT_BUTTON_COUNT)),
-					static_cast<U16>(buttonCount + (hat * HAT_BUTTON_COUNT) + 1),
-					static_cast<U16>(buttonCount + (hat * HAT_BUTTON_COUNT) + 2),
-					static_cast<U16>(buttonCount + (hat * HAT_BUTTON_COUNT) + 3)
-				};
-
-				char value = SDL_JoystickGetHat(joystick, hat);
-				bool state[HAT_BUTTON_COUNT] = {
-					static_cast<bool>((value & SDL_HAT_UP)),
-					static_cast<bool>((value & SDL_HAT_DOWN)),
-					static_cast<bool>((value & SDL_HAT_LEFT)),
-					static_cast<bool>((value & SDL_HAT_RIGHT))
-				};
-
-				for (int direction = 0; direction < HAT_BUTTON_COUNT; direction ++) {
-					if (gHatStates[i][hat][direction] != state[direction]) {
-						TGE::InputEvent event;
-						event.deviceType = TGE::JoystickDeviceType;
-						//Joystick number, probably
-						event.deviceInst = i;
-						//This is a button event
-						event.objType = SI_BUTTON;
-						//Button # offset from 0
-						event.objInst = TGE::KEY_BUTTON0 + buttonIndices[direction];
-						//MAKE for pressed, BREAK for unpress
-						event.action = (state[direction] ? SI_MAKE : SI_BREAK);
-						//1.0f for MAKE, 0.0f for BREAK
-						event.fValue = (state[direction] ? 1.0f : 0.0f);
-
-						TGE::Game->postEvent(event);
-					}
-
-					gHatStates[i][hat][direction] = state[direction];
+	//Always drain the queue so hotplugging is tracked even while disabled
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {
+		switch (event.type) {
+			case SDL_JOYDEVICEADDED:
+				openController(event.jdevice.which);
+				break;
+			case SDL_JOYDEVICEREMOVED:
+				closeController(event.jdevice.which);
+				break;
+			case SDL_JOYAXISMOTION:
+				if (gJoystick)
+					handleAxis(event.jaxis, event.jaxis.timestamp);
+				break;
+			case SDL_JOYBUTTONDOWN:
+			case SDL_JOYBUTTONUP:
+				if (gJoystick) {
+					S32 slot = findController(event.jbutton.which);
+					if (slot != -1)
+						postButtonEvent(slot, event.jbutton.button, event.jbutton.state == SDL_PRESSED);
 				}
-			}
+				break;
+			case SDL_JOYHATMOTION:
+				if (gJoystick)
+					handleHat(event.jhat);
+				break;
+			default:
+				break;
 		}
 	}
+
+	if (gJoystick && gAxisIntervalMs != 0) {
+		flushPendingAxes(SDL_GetTicks());
+	}
 }
 
 #ifdef __APPLE__
@@ -333,20 +481,8 @@ MBX_OVERRIDE_FN(const char *, TGE::cGetJoystickAxes, (TGE::SimObject *, int, con
 	static int nameCount = 7;
 
 	int joystickNum = StringMath::scan<U32>(argv[1]);
-	//Bounds checking
-	if (joystickNum >= SDL_NumJoysticks())
-		return "";
-
-	SDL_GameController *cont = SDL_GameControllerOpen(joystickNum);
-	SDL_Joystick *joystick;
-	if (cont == NULL) {
-		joystick = SDL_JoystickOpen(joystickNum);
-	} else {
-		joystick = SDL_GameControllerGetJoystick(cont);
-	}
-
+	SDL_Joystick *joystick = getJoystick(joystickNum);
 	if (joystick == NULL) {
-		TGE::Con::errorf("Controller error: %s", SDL_GetError());
 		return "";
 	}
 
@@ -372,13 +508,16 @@ MBX_OVERRIDE_FN(const char *, TGE::cGetJoystickAxes, (TGE::SimObject *, int, con
 
 MBX_CONSOLE_FUNCTION(getJoystickType, const char *, 2, 2, "getJoystickType(U32 joystickNum);") {
 	int joystickNum = StringMath::scan<U32>(argv[1]);
-	//Bounds checking
-	if (joystickNum >= SDL_NumJoysticks())
+	SDL_Joystick *joystick = getJoystick(joystickNum);
+	if (joystick == NULL)
 		return "";
 
-	const char *name = SDL_GameControllerNameForIndex(joystickNum);
+	const char *name = NULL;
+	if (gControllers[joystickNum].controller != NULL) {
+		name = SDL_GameControllerName(gControllers[joystickNum].controller);
+	}
 	if (name == NULL) {
-		name = SDL_JoystickNameForIndex(joystickNum);
+		name = SDL_JoystickName(joystick);
 	}
 
 	if (name == NULL) {
@@ -27,47 +27,151 @@
 // #define CS1200_BIMAP_H
 #pragma once
 
-template<typename Key, typename Value, template<typename ...> class structure>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Map that can be looked up in both directions. Entries are kept in one dense
+ * array, and a single open-addressing table (linear probing) holds the index
+ * of each entry twice, once for the key's probe sequence and once for the
+ * value's, so both directions share one allocation.
+ *
+ * Iteration is in insertion order, except that erasing moves the last entry
+ * into the erased one's place. Erasing invalidates iterators.
+ */
+template<typename Key, typename Value, typename KeyHash = std::hash<Key>, typename ValueHash = std::hash<Value>>
 class bimap {
 private:
-	structure<Key, Value> key_map;
-	structure<Value, Key> value_map;
+	typedef std::pair<Key, Value> entry_type;
+	typedef uint32_t index_type;
+	static const index_type empty = ~index_type(0);
+
+	struct slot {
+		index_type key_entry;
+		index_type value_entry;
+	};
+
+	std::vector<entry_type> entries;
+	std::vector<slot> slots;
+	size_t mask;
+
+	//Ids are mostly sequential, so spread them out over the table
+	static size_t mix(size_t hash) {
+		return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 32);
+	}
+
+	template<typename Hash, typename T>
+	size_t home_slot(const T &item) const {
+		return mix(Hash()(item)) & mask;
+	}
+
+	//Slot holding item, or the empty slot where it would go
+	template<typename Hash, typename T>
+	size_t find_slot(const T &item, index_type slot::*link, T entry_type::*member) const {
+		size_t i = home_slot<Hash>(item);
+		while (slots[i].*link != empty && entries[slots[i].*link].*member != item) {
+			i = (i + 1) & mask;
+		}
+		return i;
+	}
+
+	//Backward shift deletion, so lookups never need tombstones
+	template<typename Hash, typename T>
+	void clear_slot(size_t hole, index_type slot::*link, T entry_type::*member) {
+		size_t i = hole;
+		while (true) {
+			i = (i + 1) & mask;
+			if (slots[i].*link == empty)
+				break;
+			//Move it into the hole if the hole is between its home and here
+			size_t home = home_slot<Hash>(entries[slots[i].*link].*member);
+			if (((i - home) & mask) >= ((i - hole) & mask)) {
+				slots[hole].*link = slots[i].*link;
+				hole = i;
+			}
+		}
+		slots[hole].*link = empty;
+	}
+
+	void rehash(size_t capacity) {
+		slots.assign(capacity, slot{empty, empty});
+		mask = capacity - 1;
+		for (index_type i = 0; i < entries.size(); i ++) {
+			slots[find_slot<KeyHash>(entries[i].first, &slot::key_entry, &entry_type::first)].key_entry = i;
+			slots[find_slot<ValueHash>(entries[i].second, &slot::value_entry, &entry_type::second)].value_entry = i;
+		}
+	}
+
+	void erase_entry(index_type index) {
+		clear_slot<KeyHash>(find_slot<KeyHash>(entries[index].first, &slot::key_entry, &entry_type::first), &slot::key_entry, &entry_type::first);
+		clear_slot<ValueHash>(find_slot<ValueHash>(entries[index].second, &slot::value_entry, &entry_type::second), &slot::value_entry, &entry_type::second);
+
+		//Fill the gap with the last entry
+		index_type last = static_cast<index_type>(entries.size() - 1);
+		if (index != last) {
+			slots[find_slot<KeyHash>(entries[last].first, &slot::key_entry, &entry_type::first)].key_entry = index;
+			slots[find_slot<ValueHash>(entries[last].second, &slot::value_entry, &entry_type::second)].value_entry = index;
+			entries[index] = std::move(entries[last]);
+		}
+		entries.pop_back();
+	}
+
 public:
-	template<typename K, typename V>
+	bimap() {
+		rehash(16);
+	}
+
+	template<bool by_value>
 	class iterator {
 	private:
-		friend class bimap<K, V, structure>;
-		friend class bimap<V, K, structure>;
+		friend class bimap;
+		typedef typename std::conditional<by_value, std::pair<Value, Key>, std::pair<Key, Value>>::type pair_type;
 
-		iterator(typename structure<K, V>::iterator rep) : rep(rep) {}
+		iterator(const bimap *map, size_t index) : map(map), index(index) {}
 
-		typename structure<K, V>::iterator rep;
+		static std::pair<Key, Value> make_pair(const entry_type &entry, std::false_type) {
+			return entry;
+		}
+		static std::pair<Value, Key> make_pair(const entry_type &entry, std::true_type) {
+			return std::make_pair(entry.second, entry.first);
+		}
+
+		const bimap *map;
+		size_t index;
 	public:
-		iterator() : rep(NULL) {}
-		iterator(const iterator &other) : rep(other.rep) {}
+		//Entries are stored one way round, so -> needs something to point to
+		struct arrow {
+			pair_type pair;
+			const pair_type *operator->() const {
+				return &pair;
+			}
+		};
+
+		iterator() : map(nullptr), index(0) {}
 
-//		iterator<V, K> follow_link() const {
-//
-//		}
 		bool operator==(const iterator &other) const {
-			return rep == other.rep;
+			return index == other.index;
 		}
 		bool operator!=(const iterator &other) const {
 			return !operator==(other);
 		}
-		std::pair<K, V> operator*() const {
-			return *rep;
+		pair_type operator*() const {
+			return make_pair(map->entries[index], std::integral_constant<bool, by_value>());
 		}
-		std::pair<K, V> *operator->() const {
-			return (std::pair<K, V>*)(&*rep);
+		arrow operator->() const {
+			return arrow{**this};
 		}
 
 		iterator &operator++() {
-			++rep;
+			++index;
 			return *this;
 		}
 		iterator &operator--() {
-			--rep;
+			--index;
 			return *this;
 		}
 
@@ -82,66 +186,77 @@ public:
 			return temp;
 		}
 	};
-	typedef iterator<Key, Value> key_iterator;
-	typedef iterator<Value, Key> value_iterator;
+	typedef iterator<false> key_iterator;
+	typedef iterator<true> value_iterator;
 
-	decltype(key_map.size()) size() const {
-		return key_map.size();
+	size_t size() const {
+		return entries.size();
 	}
 
 	std::pair<key_iterator, bool> insert(const std::pair<Key, Value> &pair) {
-		auto inserted = key_map.insert(pair);
-		if (inserted.second) {
-			//Insert into other
-			auto value_insert = value_map.insert(std::make_pair(pair.second, pair.first));
-
-			if (!value_insert.second) {
-				key_map.erase(pair.first);
+		size_t key_slot = find_slot<KeyHash>(pair.first, &slot::key_entry, &entry_type::first);
+		if (slots[key_slot].key_entry != empty) {
+			return std::make_pair(key_iterator(this, slots[key_slot].key_entry), false);
+		}
+		size_t value_slot = find_slot<ValueHash>(pair.second, &slot::value_entry, &entry_type::second);
+		if (slots[value_slot].value_entry != empty) {
+			return std::make_pair(key_iterator(this, slots[value_slot].value_entry), false);
+		}
 
-				return std::make_pair(key_iterator(find(value_insert.first->second)), false);
-			}
+		//Keep each direction at most half full
+		if ((entries.size() + 1) * 2 > slots.size()) {
+			rehash(slots.size() * 2);
+			key_slot = find_slot<KeyHash>(pair.first, &slot::key_entry, &entry_type::first);
+			value_slot = find_slot<ValueHash>(pair.second, &slot::value_entry, &entry_type::second);
 		}
-		return std::make_pair(key_iterator(inserted.first), inserted.second);
+
+		index_type index = static_cast<index_type>(entries.size());
+		entries.push_back(pair);
+		slots[key_slot].key_entry = index;
+		slots[value_slot].value_entry = index;
+		return std::make_pair(key_iterator(this, index), true);
 	}
 	int erase(const Key &key) {
-		auto found = key_map.find(key);
-		if (found != key_map.end()) {
-			value_map.erase(found->second);
-		}
-		return key_map.erase(key);
+		index_type index = slots[find_slot<KeyHash>(key, &slot::key_entry, &entry_type::first)].key_entry;
+		if (index == empty)
+			return 0;
+		erase_entry(index);
+		return 1;
 	}
 	int erase(const Value &value) {
-		auto found = value_map.find(value);
-		if (found != value_map.end()) {
-			key_map.erase(found->second);
-		}
-		return value_map.erase(value);
+		index_type index = slots[find_slot<ValueHash>(value, &slot::value_entry, &entry_type::second)].value_entry;
+		if (index == empty)
+			return 0;
+		erase_entry(index);
+		return 1;
 	}
 
 	key_iterator find(const Key &key) {
-		return key_iterator(key_map.find(key));
+		index_type index = slots[find_slot<KeyHash>(key, &slot::key_entry, &entry_type::first)].key_entry;
+		return key_iterator(this, index == empty ? entries.size() : index);
 	}
 	value_iterator find(const Value &value) {
-		return value_iterator(value_map.find(value));
+		index_type index = slots[find_slot<ValueHash>(value, &slot::value_entry, &entry_type::second)].value_entry;
+		return value_iterator(this, index == empty ? entries.size() : index);
 	}
 
 	key_iterator key_begin() {
-		return key_iterator(key_map.begin());
+		return key_iterator(this, 0);
 	}
 	key_iterator key_end() {
-		return key_iterator(key_map.end());
+		return key_iterator(this, entries.size());
 	}
 	value_iterator value_begin() {
-		return value_iterator(value_map.begin());
+		return value_iterator(this, 0);
 	}
 	value_iterator value_end() {
-		return value_iterator(value_map.end());
+		return value_iterator(this, entries.size());
 	}
 
 	const Key &operator[](const Value &value) {
-		return find(value)->second;
+		return entries[find(value).index].first;
 	}
 	const Value &operator[](const Key &key) {
-		return find(key)->second;
+		return entries[find(key).index].second;
 	}
 };
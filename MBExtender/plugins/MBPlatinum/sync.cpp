@@ -23,9 +23,11 @@
 //-----------------------------------------------------------------------------
 
 #include <cstdlib>
+#include <algorithm>
 #include <MBExtender/MBExtender.h>
 #include <MathLib/MathLib.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <queue>
 #include <vector>
 #include <string>
@@ -40,6 +42,7 @@
 #include <TorqueLib/core/stringTable.h>
 #include <TorqueLib/game/gameBase.h>
 #include <TorqueLib/game/gameConnection.h>
+#include <TorqueLib/math/mMathIo.h>
 #include <TorqueLib/sim/netObject.h>
 
 #define DEBUG_SYNC_OBJECTS 0
@@ -88,7 +91,7 @@ MBX_MODULE(Sync);
 typedef S32 SyncId;
 
 template<typename Key, typename Value>
-using bidirectional_map = bimap<Key, Value, std::unordered_map>;
+using bidirectional_map = bimap<Key, Value>;
 
 /// The global ID value that is used for generating the sync IDs.
 SyncId gSyncId = 0;
@@ -100,6 +103,8 @@ bidirectional_map<SyncId, SimObjectId> gClientGhostActiveList;
 bidirectional_map<SyncId, SimObjectId> gServerGhostActiveList;
 
 void finishSyncFields(TGE::NetObject *object);
+void forgetServerSyncObject(SyncId syncId);
+void markFieldsChanged(SimObjectId objectId);
 
 //-----------------------------------------------------------------------------
 
@@ -241,28 +246,20 @@ MBX_OVERRIDE_MEMBERFN(bool, TGE::NetObject::onAdd, (TGE::NetObject *thisptr), or
 MBX_OVERRIDE_MEMBERFN(void, TGE::NetObject::onRemove, (TGE::NetObject *thisptr), originalOnRemove) {
 	// Clear from list.
 	if (thisptr->isClientObject()) {
-		auto iter = gClientGhostActiveList.key_begin();
-		while (iter != gClientGhostActiveList.key_end()) {
-			// Remove reference from the map if the object no longer exists
-			if (TGE::Sim::findObject(StringMath::print<SimObjectId>((*iter).second)) == thisptr)
-				gClientGhostActiveList.erase((*(iter++)).first);
-			else
-				++iter;
-		}
+		gClientGhostActiveList.erase(thisptr->getId());
 	} else {
-		auto iter = gServerGhostActiveList.key_begin();
-		while (iter != gServerGhostActiveList.key_end()) {
-			// Remove reference from the map if the object no longer exists
-			if (TGE::Sim::findObject(StringMath::print<SimObjectId>((*iter).second)) == thisptr)
-				gServerGhostActiveList.erase((*(iter++)).first);
-			else
-				++iter;
-		}
+		forgetServerSyncObject(getSyncId(thisptr));
+		gServerGhostActiveList.erase(thisptr->getId());
 	}
 
 	originalOnRemove(thisptr);
 }
 
+MBX_OVERRIDE_MEMBERFN(void, TGE::SimObject::setDataField, (TGE::SimObject *thisptr, const char *slotName, const char *array, const char *value), originalSetDataField) {
+	originalSetDataField(thisptr, slotName, array, value);
+	markFieldsChanged(thisptr->getId());
+}
+
 MBX_OVERRIDE_MEMBERFN(U32, TGE::NetObject::packUpdate, (TGE::NetObject *thisptr, TGE::NetConnection *conn, U32 mask, TGE::BitStream *stream), originalNetObjectPackUpdate) {
 	if (getSyncId(thisptr->getId(), gServerGhostActiveList) == -1) {
 		// Save it to the ghost active list
@@ -451,6 +448,12 @@ struct ObjectField {
 	std::string value;
 	int arrayIndex;
 	bool isArray;
+
+	//[SERVER] Id for the name in the connection's field name dictionary, or -1
+	// to send the name itself. The first time a name is sent it also carries
+	// the string so the client can add it to its dictionary.
+	S32 nameId;
+	bool defineName;
 };
 
 struct SyncFields {
@@ -468,8 +471,91 @@ struct SyncFields {
 
 std::unordered_map<SyncId, SyncFields> gSyncObjectsTodo;
 
+//Field names are replaced with small ids after they have been sent once on a
+// connection. Sync events are sent in order, so a name's definition always
+// arrives before anything that uses its id.
+static const U32 FieldNameIdBits = 10;
+static const U32 MaxFieldNames = 1 << FieldNameIdBits;
+
+//Objects that don't fit in one event are split into fragments of about this
+// many bytes, which leaves room in the packet for everything else.
+static const U32 SyncFragmentBytes = 800;
+//Fields and commands are counted in 8 bits per fragment
+static const U32 MaxFragmentEntries = 255;
+
+//[SERVER] An object waiting to be sent. Anything not sent yet is all that's
+// left in fields.
+struct PendingSync {
+	SimObjectId objectId;
+	SyncFields fields;
+	U32 order;
+};
+
+//[SERVER] What has been sent on each connection, so only field names that are
+// new and fields that have changed get sent again
+struct SyncConnectionState {
+	std::unordered_map<std::string, U32> nameIds;
+	std::unordered_map<SyncId, std::unordered_map<std::string, std::string>> sentValues;
+
+	std::unordered_map<SyncId, PendingSync> pending;
+	U32 nextOrder = 0;
+
+	//Value of gFieldVersions when each object's dynamic fields were last listed
+	std::unordered_map<SyncId, U32> fieldVersions;
+};
+std::unordered_map<SimObjectId, SyncConnectionState> gSyncConnections;
+
+//[SERVER] Higher priority objects are sent first, default is 0
+std::unordered_map<SyncId, S32> gSyncPriorities;
+
+//[SERVER] Changes whenever a field is set on a sync object, so objects whose
+// dynamic fields haven't changed don't need to be listed again
+std::unordered_map<SyncId, U32> gFieldVersions;
+U32 gNextFieldVersion = 1;
+
+//Names of each class's member fields, so they can be left out of the dynamic
+// fields. Names are StringTable entries, so they can be compared as pointers.
+std::unordered_map<TGE::AbstractClassRep *, std::unordered_set<const char *>> gMemberFieldNames;
+
+const std::unordered_set<const char *> &getMemberFieldNames(TGE::AbstractClassRep *rep) {
+	auto found = gMemberFieldNames.find(rep);
+	if (found != gMemberFieldNames.end())
+		return found->second;
+
+	std::unordered_set<const char *> &names = gMemberFieldNames[rep];
+	TGE::AbstractClassRep::FieldList list = rep->getFieldList();
+	for (S32 i = 0; i < list.size(); i ++) {
+		names.insert(list[i].pFieldname);
+	}
+	return names;
+}
+
+//[SERVER] Bytes of sync fields to send per connection each tick. At least one
+// fragment is always sent so big objects still get through.
+U32 gSyncBytesPerTick = 4000;
+
+//[SERVER] Length of a sync tick, same as the engine's 32ms tick. Client process
+// runs every frame, so time is accumulated until a whole tick has passed.
+const U32 SyncTickMs = 32;
+U32 gSyncTickTime = 0;
+
+//[CLIENT] Field name dictionary and the combined state of every object for
+// the connection to the server. Sync events only carry what changed, so this
+// is what gets applied when an object is ghosted (again).
+struct ClientSyncState {
+	SyncFields fields;
+	SimObjectId appliedTo = 0;
+};
+SimObjectId gClientSyncConnection = 0;
+std::vector<std::string> gClientFieldNames;
+std::unordered_map<SyncId, ClientSyncState> gClientSyncState;
+
+//Stats for getSyncFieldStats()
+U32 gSyncFieldsSent = 0;
+U32 gSyncFieldsSkipped = 0;
+
 //List all registered member fields and their values
-void getObjectFields(TGE::NetObject *object, SyncFields &fields) {
+void getObjectFields(TGE::NetObject *object, SyncFields &fields, bool includeDynamic) {
 	fields.objectName = object->mName ? object->mName : "";
 	fields.syncId = getSyncId(object);
 
@@ -491,38 +577,32 @@ void getObjectFields(TGE::NetObject *object, SyncFields &fields) {
 
 			if (field.elementCount == 1) {
 				//Single field
-				fields.fields.push_back({list[i].pFieldname, val, -1, false});
+				fields.fields.push_back({list[i].pFieldname, val, -1, false, -1, false});
 			} else {
 				//Array
-				fields.fields.push_back({list[i].pFieldname, val, j, true});
+				fields.fields.push_back({list[i].pFieldname, val, j, true, -1, false});
 			}
 		}
 	}
 
 	//List all dynamic fields
+	if (!includeDynamic)
+		return;
 
-	std::vector<TGE::SimFieldDictionary::Entry *> entries;
 	TGE::SimFieldDictionary *dict = object->mFieldDictionary;
 	if (dict) {
+		const std::unordered_set<const char *> &memberNames = getMemberFieldNames(object->getClassRep());
+
 		//Make sure we get all the fields in all the hash buckets
 		for (U32 i = 0; i < TGE::SimFieldDictionary::HashTableSize; i ++) {
 			for (TGE::SimFieldDictionary::Entry *walk = dict->mHashTable[i]; walk; walk = walk->next) {
 				//Don't include any dynamic fields with the same name as a member field
-				S32 j = 0;
-				for (j = 0; j < list.size(); j ++)
-					if (list[j].pFieldname == walk->slotName)
-						break;
-				//If we didn't get to the end of the list then we hit one
-				if (j != list.size())
+				if (memberNames.find(walk->slotName) != memberNames.end())
 					continue;
 
-				entries.push_back(walk);
+				fields.fields.push_back({walk->slotName, walk->value, -1, false, -1, false});
 			}
 		}
-
-		for (std::vector<TGE::SimFieldDictionary::Entry *>::iterator it = entries.begin(); it != entries.end(); it++) {
-			fields.fields.push_back({(*it)->slotName, (*it)->value, -1, false});
-		}
 	}
 }
 
@@ -542,6 +622,220 @@ void setObjectFields(TGE::SimObject *object, const SyncFields &fields) {
 	}
 }
 
+std::string readStdString(TGE::BitStream *stream);
+void writeStdString(TGE::BitStream *stream, const std::string &str);
+
+static std::string getFieldKey(const ObjectField &field) {
+	if (!field.isArray)
+		return field.name;
+	return field.name + "[" + std::to_string(field.arrayIndex) + "]";
+}
+
+/**
+ * Combine two field lists, values from src replace the ones in dest.
+ */
+void mergeFields(std::vector<ObjectField> &dest, std::vector<ObjectField> &src) {
+	for (ObjectField &field : src) {
+		auto existing = std::find_if(dest.begin(), dest.end(), [&field](const ObjectField &other) {
+			return other.isArray == field.isArray && other.arrayIndex == field.arrayIndex && other.name == field.name;
+		});
+		if (existing == dest.end()) {
+			dest.push_back(std::move(field));
+		} else {
+			existing->value = std::move(field.value);
+		}
+	}
+}
+
+SyncConnectionState &getConnectionState(TGE::NetConnection *connection) {
+	auto found = gSyncConnections.find(connection->getId());
+	if (found != gSyncConnections.end())
+		return found->second;
+
+	//New connection, forget about any that have gone away
+	for (auto it = gSyncConnections.begin(); it != gSyncConnections.end(); ) {
+		if (TGE::Sim::findObject(StringMath::print(it->first)) == NULL)
+			it = gSyncConnections.erase(it);
+		else
+			++it;
+	}
+	return gSyncConnections[connection->getId()];
+}
+
+/**
+ * [SERVER] Sync ids are never reused, so there's no need to remember anything
+ * about removed objects.
+ */
+void forgetServerSyncObject(SyncId syncId) {
+	for (auto &pair : gSyncConnections) {
+		pair.second.sentValues.erase(syncId);
+		pair.second.pending.erase(syncId);
+		pair.second.fieldVersions.erase(syncId);
+	}
+	gSyncPriorities.erase(syncId);
+	gFieldVersions.erase(syncId);
+}
+
+/**
+ * [SERVER] Note that an object's dynamic fields need to be listed again.
+ */
+void markFieldsChanged(SimObjectId objectId) {
+	SyncId syncId = getSyncId(objectId, gServerGhostActiveList);
+	if (syncId != -1) {
+		gFieldVersions[syncId] = gNextFieldVersion ++;
+	}
+}
+
+/**
+ * [SERVER] Remove fields the connection already has the current value of.
+ */
+void makeFieldDelta(SyncConnectionState &state, SyncFields &fields) {
+	auto &sent = state.sentValues[fields.syncId];
+
+	size_t kept = 0;
+	for (size_t i = 0; i < fields.fields.size(); i ++) {
+		ObjectField &field = fields.fields[i];
+		std::string key = getFieldKey(field);
+		auto found = sent.find(key);
+		if (found != sent.end() && found->second == field.value) {
+			gSyncFieldsSkipped ++;
+			continue;
+		}
+		sent[key] = field.value;
+		gSyncFieldsSent ++;
+
+		if (kept != i) {
+			fields.fields[kept] = std::move(field);
+		}
+		kept ++;
+	}
+	fields.fields.resize(kept);
+}
+
+/**
+ * [SERVER] Pick the dictionary id for a field's name. This happens as fields
+ * are sent, since that's the order the client sees them in.
+ */
+void assignFieldName(SyncConnectionState &state, ObjectField &field) {
+	auto id = state.nameIds.find(field.name);
+	if (id != state.nameIds.end()) {
+		field.nameId = id->second;
+		field.defineName = false;
+	} else if (state.nameIds.size() < MaxFieldNames) {
+		field.nameId = state.nameIds.size();
+		field.defineName = true;
+		state.nameIds[field.name] = field.nameId;
+	} else {
+		//Dictionary is full, send the name
+		field.nameId = -1;
+		field.defineName = false;
+	}
+}
+
+/**
+ * [SERVER] Move as much of an object as fits in one event into a fragment.
+ * Fields go first, then commands, so the commands run once the client has
+ * every field.
+ * @return Roughly how many bytes the fragment will take.
+ */
+U32 takeSyncFragment(SyncConnectionState &state, SyncFields &from, SyncFields &fragment) {
+	fragment.objectName = from.objectName;
+	fragment.syncId = from.syncId;
+
+	U32 size = from.objectName.size() + 8;
+	size_t count = 0;
+	while (count < from.fields.size() && count < MaxFragmentEntries && (count == 0 || size < SyncFragmentBytes)) {
+		ObjectField &field = from.fields[count];
+		assignFieldName(state, field);
+		size += (field.nameId >= 0 && !field.defineName ? 2 : field.name.size() + 3) + field.value.size() + 2;
+		count ++;
+	}
+	fragment.fields.assign(std::make_move_iterator(from.fields.begin()), std::make_move_iterator(from.fields.begin() + count));
+	from.fields.erase(from.fields.begin(), from.fields.begin() + count);
+
+	if (from.fields.empty()) {
+		count = 0;
+		while (count < from.commands.size() && count < MaxFragmentEntries && size < SyncFragmentBytes) {
+			const SyncFields::SyncCommand &command = from.commands[count];
+			size += command.finishCmd.size() + 2;
+			for (const std::string &arg : command.finishArgs) {
+				size += arg.size() + 1;
+			}
+			count ++;
+		}
+		fragment.commands.assign(std::make_move_iterator(from.commands.begin()), std::make_move_iterator(from.commands.begin() + count));
+		from.commands.erase(from.commands.begin(), from.commands.begin() + count);
+	}
+	return size;
+}
+
+//How a field value is sent
+enum FieldValueType {
+	StringValue = 0,
+	SmallIntValue = 1,
+	IntValue = 2,
+	FloatValue = 3
+};
+
+/**
+ * Write a field value, in binary if it's a number that converts back to the
+ * exact same string.
+ */
+void writeFieldValue(TGE::BitStream *stream, const std::string &value) {
+	if (!value.empty() && value.size() < 16) {
+		char printed[32];
+		char *end;
+
+		long parsed = strtol(value.c_str(), &end, 10);
+		if (*end == 0 && parsed >= INT32_MIN && parsed <= INT32_MAX) {
+			snprintf(printed, sizeof(printed), "%d", static_cast<S32>(parsed));
+			if (value == printed) {
+				if (parsed >= -128 && parsed < 128) {
+					stream->writeInt(SmallIntValue, 2);
+					stream->writeInt(static_cast<S32>(parsed) + 128, 8);
+				} else {
+					stream->writeInt(IntValue, 2);
+					stream->writeInt(static_cast<S32>(parsed), 32);
+				}
+				return;
+			}
+		}
+
+		F32 parsedFloat = strtof(value.c_str(), &end);
+		if (*end == 0) {
+			snprintf(printed, sizeof(printed), "%.7g", parsedFloat);
+			if (value == printed) {
+				stream->writeInt(FloatValue, 2);
+				MathIO::write(stream, parsedFloat);
+				return;
+			}
+		}
+	}
+
+	stream->writeInt(StringValue, 2);
+	writeStdString(stream, value);
+}
+
+std::string readFieldValue(TGE::BitStream *stream) {
+	char printed[32];
+	switch (stream->readInt(2)) {
+		case SmallIntValue:
+			snprintf(printed, sizeof(printed), "%d", stream->readInt(8) - 128);
+			return printed;
+		case IntValue:
+			snprintf(printed, sizeof(printed), "%d", stream->readInt(32));
+			return printed;
+		case FloatValue: {
+			F32 value;
+			MathIO::read(stream, &value);
+			snprintf(printed, sizeof(printed), "%.7g", value);
+			return printed;
+		}
+		default:
+			return readStdString(stream);
+	}
+}
+
 std::string readStdString(TGE::BitStream *stream) {
 	char buf[256];
 	stream->readString(buf);
@@ -552,11 +846,11 @@ void writeStdString(TGE::BitStream *stream, const std::string &str) {
 	stream->writeString(str.c_str(), str.size());
 }
 
-void readFieldList(TGE::BitStream *stream, SyncFields &list) {
+void readFieldList(TGE::BitStream *stream, SyncFields &list, std::vector<std::string> &names) {
 	list.objectName = readStdString(stream);
 	list.syncId = stream->readInt(32);
 	if (stream->readFlag()) {
-		S32 commands = stream->readInt(4);
+		S32 commands = stream->readInt(8);
 		for (int i = 0; i < commands; i ++) {
 			SyncFields::SyncCommand command;
 			if (stream->readFlag()) {
@@ -574,11 +868,31 @@ void readFieldList(TGE::BitStream *stream, SyncFields &list) {
 	list.fields.clear();
 	for (S32 i = 0; i < fieldCount; i ++) {
 		ObjectField field;
-		field.name = readStdString(stream);
+		if (stream->readFlag()) {
+			U32 nameId = stream->readInt(FieldNameIdBits);
+			if (stream->readFlag()) {
+				//First use of this name
+				if (names.size() <= nameId) {
+					names.resize(nameId + 1);
+				}
+				names[nameId] = readStdString(stream);
+			}
+			if (nameId < names.size()) {
+				field.name = names[nameId];
+			}
+		} else {
+			field.name = readStdString(stream);
+		}
+		field.arrayIndex = -1;
 		if ((field.isArray = stream->readFlag())) {
 			field.arrayIndex = stream->readInt(8);
 		}
-		field.value = readStdString(stream);
+		field.value = readFieldValue(stream);
+
+		if (field.name.empty()) {
+			TGE::Con::errorf("Sync field with unknown name id!");
+			continue;
+		}
 		list.fields.push_back(field);
 	}
 }
@@ -587,11 +901,11 @@ bool writeFieldList(TGE::BitStream *stream, const SyncFields &list) {
 	writeStdString(stream, list.objectName);
 	stream->writeInt(list.syncId, 32);
 	if (stream->writeFlag(list.commands.size() > 0)) {
-		if (list.commands.size() > 15) {
-			TGE::Con::errorf("Too many sync commands? %d > 15", list.commands.size());
+		if (list.commands.size() > MaxFragmentEntries) {
+			TGE::Con::errorf("Too many sync commands? %d > %d", list.commands.size(), MaxFragmentEntries);
 			return false;
 		}
-		stream->writeInt(list.commands.size(), 4); //Only really need one of these but I'll support more just in case
+		stream->writeInt(list.commands.size(), 8);
 		for (const auto &command : list.commands) {
 			if (stream->writeFlag(command.finishCmd.size())) {
 				writeStdString(stream, command.finishCmd);
@@ -604,20 +918,27 @@ bool writeFieldList(TGE::BitStream *stream, const SyncFields &list) {
 		}
 	}
 
-	if (list.fields.size() > 255) {
-		//Oh holy hell this is not getting through in one packet
-		TGE::Con::errorf("Too many fields for one sync object! %d > 255", list.fields.size());
+	if (list.fields.size() > MaxFragmentEntries) {
+		//Should have been split by takeSyncFragment
+		TGE::Con::errorf("Too many fields for one sync fragment! %d > %d", list.fields.size(), MaxFragmentEntries);
 		return false;
 	}
 
 	stream->writeInt(list.fields.size(), 8);
 	for (const ObjectField &field : list.fields) {
-		writeStdString(stream, field.name);
+		if (stream->writeFlag(field.nameId >= 0)) {
+			stream->writeInt(field.nameId, FieldNameIdBits);
+			if (stream->writeFlag(field.defineName)) {
+				writeStdString(stream, field.name);
+			}
+		} else {
+			writeStdString(stream, field.name);
+		}
 		if (stream->writeFlag(field.isArray)) {
 			//8 seems enough
 			stream->writeInt(field.arrayIndex, 8);
 		}
-		writeStdString(stream, field.value);
+		writeFieldValue(stream, field.value);
 	}
 	return true;
 }
@@ -675,33 +996,34 @@ public:
 	TGE::NetObject *sync;
 	SyncFields fields;
 	S32 id;
+	//If this is the last fragment of the object
+	bool last;
 
 	virtual bool pack(TGE::NetConnection *connection, TGE::BitStream *stream);
 	virtual bool unpack(TGE::NetConnection *connection, TGE::BitStream *stream);
 	virtual bool process(TGE::NetConnection *connection);
-	virtual void notifyDelivered(TGE::NetConnection *connection, bool madeIt);
+	virtual void notifyDelivered(TGE::NetConnection *connection, bool madeIt) {}
 };
 
 class SyncBatchEvent : public CustomNetEvent {
 public:
-	std::unordered_map<SyncId, SyncFieldsEvent *> fieldEvents;
-
 	virtual bool pack(TGE::NetConnection *connection, TGE::BitStream *stream);
 	virtual bool unpack(TGE::NetConnection *connection, TGE::BitStream *stream);
 	virtual bool process(TGE::NetConnection *connection);
-	virtual void notifyDelivered(TGE::NetConnection *connection, bool madeIt);
+	virtual void notifyDelivered(TGE::NetConnection *connection, bool madeIt) {}
+	//Only marks the end of a batch, so it can share a net event with others
+	virtual U32 getMaxPackedBits() const { return 0; }
 };
 
 std::unordered_map<SyncId, SyncFields> gWaitingFields;
-std::unordered_map<TGE::NetConnection *, SyncBatchEvent *> gSyncBatchEvents;
+//[CLIENT] Objects in gWaitingFields that still have fragments on the way
+std::unordered_set<SyncId> gIncompleteFields;
 
 bool SyncFieldsEvent::pack(TGE::NetConnection *connection, TGE::BitStream *stream) {
-	if (gSyncBatchEvents.find(connection) != gSyncBatchEvents.end()) {
-		gSyncBatchEvents[connection]->fieldEvents.erase(fields.syncId);
-	}
 	id = connection->getGhostIndex(sync);
 
 	stream->writeInt(id, 16);
+	stream->writeFlag(last);
 	writeFieldList(stream, fields);
 
 #if DEBUG_SYNC_OBJECTS
@@ -718,9 +1040,18 @@ bool SyncFieldsEvent::pack(TGE::NetConnection *connection, TGE::BitStream *strea
 
 bool SyncFieldsEvent::unpack(TGE::NetConnection *connection, TGE::BitStream *stream) {
 	id = stream->readInt(16);
+	last = stream->readFlag();
+
+	//Dictionary and state only make sense for one server
+	if (connection->getId() != gClientSyncConnection) {
+		gClientSyncConnection = connection->getId();
+		gClientFieldNames.clear();
+		gClientSyncState.clear();
+		gIncompleteFields.clear();
+	}
 
 	sync = nullptr;
-	readFieldList(stream, fields);
+	readFieldList(stream, fields, gClientFieldNames);
 
 	return true;
 }
@@ -734,43 +1065,37 @@ bool SyncFieldsEvent::process(TGE::NetConnection *connection) {
 		gWaitingFields[fields.syncId] = std::move(fields);
 	} else {
 		//Combine them
-		const auto &todo = gWaitingFields[fields.syncId];
-		//Keep old commands, nothing else
-		fields.commands.insert(fields.commands.end(), std::make_move_iterator(todo.commands.begin()), std::make_move_iterator(todo.commands.end()));
+		auto &todo = gWaitingFields[fields.syncId];
+		if (gIncompleteFields.find(fields.syncId) != gIncompleteFields.end()) {
+			//Another fragment of the same object, commands stay in order
+			todo.commands.insert(todo.commands.end(), std::make_move_iterator(fields.commands.begin()), std::make_move_iterator(fields.commands.end()));
+		} else {
+			//Keep old commands, fields are only what changed so they add up
+			fields.commands.insert(fields.commands.end(), std::make_move_iterator(todo.commands.begin()), std::make_move_iterator(todo.commands.end()));
+			todo.commands = std::move(fields.commands);
+		}
+		mergeFields(todo.fields, fields.fields);
+		todo.objectName = fields.objectName;
 
 #if DEBUG_SYNC_OBJECTS
 		TGE::Con::printf("Combine sync wait: %d", fields.syncId);
-		dumpSyncFields(fields);
+		dumpSyncFields(todo);
 #endif
-		gWaitingFields[fields.syncId] = std::move(fields);
 	}
 
-	if (gSyncBatchEvents.find(connection) != gSyncBatchEvents.end()) {
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Free sync field event: %d", fields.syncId);
-		dumpSyncFields(fields);
-#endif
-
-		gSyncBatchEvents[connection]->fieldEvents.erase(fields.syncId);
+	if (last) {
+		gIncompleteFields.erase(fields.syncId);
+	} else {
+		gIncompleteFields.insert(fields.syncId);
 	}
 
 	return true;
 }
 
-void SyncFieldsEvent::notifyDelivered(TGE::NetConnection *connection, bool madeIt) {
-	if (gSyncBatchEvents.find(connection) != gSyncBatchEvents.end()) {
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Free sync field event: %d (success: %d)", fields.syncId, madeIt);
-		dumpSyncFields(fields);
-#endif
-
-		gSyncBatchEvents[connection]->fieldEvents.erase(fields.syncId);
-	}
-}
-
 bool SyncBatchEvent::pack(TGE::NetConnection *connection, TGE::BitStream *stream) {
-	gSyncBatchEvents.erase(connection);
+#if DEBUG_SYNC_OBJECTS
 	TGE::Con::printf("Process batch sent");
+#endif
 	return true;
 }
 
@@ -779,11 +1104,26 @@ bool SyncBatchEvent::unpack(TGE::NetConnection *connection, TGE::BitStream *stre
 }
 
 bool SyncBatchEvent::process(TGE::NetConnection *connection) {
+#if DEBUG_SYNC_OBJECTS
 	TGE::Con::printf("Process batch rcvd");
-	for (auto &pair : gWaitingFields) {
-		auto &fields = pair.second;
+#endif
+	for (auto it = gWaitingFields.begin(); it != gWaitingFields.end(); ) {
+		//Wait for the rest of it, it'll be in a later batch
+		if (gIncompleteFields.find(it->first) != gIncompleteFields.end()) {
+			++it;
+			continue;
+		}
+
+		auto &fields = it->second;
 		TGE::NetObject *sync = nullptr;
 
+		//Keep everything for when the object is ghosted again
+		ClientSyncState &state = gClientSyncState[fields.syncId];
+		std::vector<ObjectField> changed(fields.fields);
+		mergeFields(state.fields.fields, changed);
+		state.fields.objectName = fields.objectName;
+		state.fields.syncId = fields.syncId;
+
 		//Try to find via sync id?
 		auto found = gClientGhostActiveList.find(fields.syncId);
 		if (found != gClientGhostActiveList.key_end()) {
@@ -795,67 +1135,57 @@ bool SyncBatchEvent::process(TGE::NetConnection *connection) {
 				dumpSyncFields(fields);
 #endif
 				applySyncFields(sync, fields);
+				state.appliedTo = sync->getId();
+				it = gWaitingFields.erase(it);
 				continue;
 			}
 		}
 		sync = nullptr;
 		if (gSyncObjectsTodo.find(fields.syncId) == gSyncObjectsTodo.end()) {
-			gSyncObjectsTodo[fields.syncId] = std::move(fields);
 #if DEBUG_SYNC_OBJECTS
 			TGE::Con::printf("Add sync todo: %d", fields.syncId);
 			dumpSyncFields(fields);
 #endif
+			gSyncObjectsTodo[fields.syncId] = std::move(fields);
 		} else {
 			//Combine them
-			const auto &todo = gSyncObjectsTodo[fields.syncId];
-			//Keep old commands, nothing else
+			auto &todo = gSyncObjectsTodo[fields.syncId];
+			//Keep old commands, fields are only what changed so they add up
 			fields.commands.insert(fields.commands.end(), std::make_move_iterator(todo.commands.begin()), std::make_move_iterator(todo.commands.end()));
-			gSyncObjectsTodo[fields.syncId] = std::move(fields);
+			mergeFields(todo.fields, fields.fields);
+			todo.commands = std::move(fields.commands);
+			todo.objectName = fields.objectName;
 
 #if DEBUG_SYNC_OBJECTS
 			TGE::Con::printf("Combine sync todo: %d", fields.syncId);
-			dumpSyncFields(fields);
+			dumpSyncFields(todo);
 #endif
 		}
-	}
-	gWaitingFields.clear();
-
-	auto found = gSyncBatchEvents.find(connection);
-	if (found != gSyncBatchEvents.end() && found->second == this) {
-		gSyncBatchEvents.erase(found);
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Free batch event");
-		for (const auto &pair : fieldEvents) {
-			dumpSyncFields(pair.second->fields);
-		}
-#endif
+		it = gWaitingFields.erase(it);
 	}
 	return true;
 }
 
-void SyncBatchEvent::notifyDelivered(TGE::NetConnection *connection, bool madeIt) {
-	auto found = gSyncBatchEvents.find(connection);
-	if (found != gSyncBatchEvents.end() && found->second == this) {
-		gSyncBatchEvents.erase(found);
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Free batch event: (success: %d)", madeIt);
-		for (const auto &pair : fieldEvents) {
-			dumpSyncFields(pair.second->fields);
-		}
-#endif
-	}
-}
-
 void finishSyncFields(TGE::NetObject *object) {
 	SyncId sid = getSyncId(object);
+	auto state = gClientSyncState.find(sid);
 	auto found = gSyncObjectsTodo.find(sid);
 	if (found != gSyncObjectsTodo.end()) {
 #if DEBUG_SYNC_OBJECTS
 		TGE::Con::printf("Found sync in todo: %d", found->first);
 		dumpSyncFields(found->second);
 #endif
+		//The todo only has what changed while there was no object
+		if (state != gClientSyncState.end()) {
+			found->second.fields = state->second.fields.fields;
+			state->second.appliedTo = object->getId();
+		}
 		applySyncFields(object, found->second);
 		gSyncObjectsTodo.erase(found);
+	} else if (state != gClientSyncState.end() && state->second.appliedTo != object->getId()) {
+		//Ghosted again, it needs everything
+		applySyncFields(object, state->second.fields);
+		state->second.appliedTo = object->getId();
 	} else {
 #if DEBUG_SYNC_OBJECTS
 		//TGE::Con::printf("Could not find in todo: %d", sid);
@@ -866,6 +1196,89 @@ void finishSyncFields(TGE::NetObject *object) {
 CustomEventConstructor<SyncFieldsEvent> SyncFieldsEventConstructor{};
 CustomEventConstructor<SyncBatchEvent> SyncBatchEventsConstructor{};
 
+/**
+ * [SERVER] Post as many waiting objects as fit in this tick's budget, most
+ * important first, then end the batch so the client applies them.
+ */
+void sendPendingSyncFields(TGE::NetConnection *connection, SyncConnectionState &state) {
+	std::vector<SyncId> order;
+	order.reserve(state.pending.size());
+	for (const auto &pair : state.pending) {
+		order.push_back(pair.first);
+	}
+	//Highest priority first, then in the order they were synced
+	std::sort(order.begin(), order.end(), [&state](SyncId a, SyncId b) {
+		auto priorityA = gSyncPriorities.find(a);
+		auto priorityB = gSyncPriorities.find(b);
+		S32 pa = (priorityA == gSyncPriorities.end() ? 0 : priorityA->second);
+		S32 pb = (priorityB == gSyncPriorities.end() ? 0 : priorityB->second);
+		if (pa != pb)
+			return pa > pb;
+		return state.pending[a].order < state.pending[b].order;
+	});
+
+	U32 sent = 0;
+	bool posted = false;
+	for (SyncId syncId : order) {
+		if (posted && sent >= gSyncBytesPerTick)
+			break;
+
+		auto found = state.pending.find(syncId);
+		PendingSync &pending = found->second;
+		TGE::NetObject *sync = static_cast<TGE::NetObject *>(TGE::Sim::findObject(StringMath::print(pending.objectId)));
+		if (sync == nullptr) {
+			state.pending.erase(found);
+			continue;
+		}
+
+		bool complete = false;
+		while (!complete && (!posted || sent < gSyncBytesPerTick)) {
+			SyncFieldsEvent *event = SyncFieldsEventConstructor.createSubtype();
+			event->sync = sync;
+			sent += takeSyncFragment(state, pending.fields, event->fields);
+			complete = pending.fields.fields.empty() && pending.fields.commands.empty();
+			event->last = complete;
+			//Ordered, since field names and values build on earlier events
+			event->post(connection, TGE::NetEvent::GuaranteedOrdered);
+			posted = true;
+#if DEBUG_SYNC_OBJECTS
+			TGE::Con::printf("Sent Sync Fields (last: %d):", complete);
+			dumpSyncFields(event->fields);
+#endif
+		}
+		if (complete) {
+			state.pending.erase(found);
+		}
+	}
+
+	if (posted) {
+		SyncBatchEvent *batch = SyncBatchEventsConstructor.createSubtype();
+		batch->post(connection);
+	}
+}
+
+MBX_ON_CLIENT_PROCESS(sendSyncFields, (uint32_t delta)) {
+	gSyncTickTime += delta;
+	if (gSyncTickTime < SyncTickMs)
+		return;
+	//One budget per send, so a long frame doesn't burst several ticks at once
+	gSyncTickTime %= SyncTickMs;
+
+	for (auto it = gSyncConnections.begin(); it != gSyncConnections.end(); ) {
+		if (it->second.pending.empty()) {
+			++it;
+			continue;
+		}
+		TGE::SimObject *connection = TGE::Sim::findObject(StringMath::print(it->first));
+		if (connection == nullptr) {
+			it = gSyncConnections.erase(it);
+			continue;
+		}
+		sendPendingSyncFields(static_cast<TGE::NetConnection *>(connection), it->second);
+		++it;
+	}
+}
+
 MBX_CONSOLE_METHOD(GameConnection, syncObject1, void, 3, 10, "syncObject(obj, [finishcmd, [arg0] ]") {
 	TGE::SimObject *obj = TGE::Sim::findObject(argv[2]);
 	if (!obj) {
@@ -876,9 +1289,21 @@ MBX_CONSOLE_METHOD(GameConnection, syncObject1, void, 3, 10, "syncObject(obj, [f
 		return;
 	}
 
-	SyncFieldsEvent *event = SyncFieldsEventConstructor.createSubtype();
-	event->sync = sync;
-	getObjectFields(sync, event->fields);
+	SyncConnectionState &state = getConnectionState(object);
+
+	//Dynamic fields only change through setDataField, so skip them if that
+	// hasn't happened since they were last listed for this connection.
+	// Member fields can change from code and always need checking.
+	SyncId syncId = getSyncId(sync);
+	auto version = gFieldVersions.find(syncId);
+	U32 currentVersion = (version == gFieldVersions.end() ? 0 : version->second);
+	auto listed = state.fieldVersions.find(syncId);
+	bool includeDynamic = (listed == state.fieldVersions.end() || listed->second != currentVersion);
+	state.fieldVersions[syncId] = currentVersion;
+
+	SyncFields fields;
+	getObjectFields(sync, fields, includeDynamic);
+	makeFieldDelta(state, fields);
 	if (argc > 3) {
 		if (strlen(argv[3]) > 0) {
 			SyncFields::SyncCommand command;
@@ -889,58 +1314,42 @@ MBX_CONSOLE_METHOD(GameConnection, syncObject1, void, 3, 10, "syncObject(obj, [f
 				}
 			}
 
-			event->fields.commands.push_back(command);
+			fields.commands.push_back(command);
 		}
 	}
 
-	bool shouldPost = false;
-	SyncBatchEvent *batch = nullptr;
-
-	if (gSyncBatchEvents.find(object) == gSyncBatchEvents.end()) {
-		TGE::Con::printf("Process batch create");
-		batch = SyncBatchEventsConstructor.createSubtype();
-
-		gSyncBatchEvents[object] = batch;
-		shouldPost = true;
-	} else {
-		batch = gSyncBatchEvents[object];
-	}
-
-	if (batch == nullptr) {
-		TGE::Con::errorf("Batch event is null!");
-		return;
-	}
-
-	//See if we can find the event in the batch object
-	const auto &found = batch->fieldEvents.find(event->fields.syncId);
-	if (found == batch->fieldEvents.end() || found->second == nullptr) {
-		batch->fieldEvents[event->fields.syncId] = event;
-		event->post(object, TGE::NetEvent::Guaranteed);
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Sent Sync Fields:");
-		dumpSyncFields(event->fields);
-#endif
+	//Sent on the next tick along with everything else for this connection
+	auto found = state.pending.find(fields.syncId);
+	if (found == state.pending.end()) {
+		PendingSync &pending = state.pending[fields.syncId];
+		pending.objectId = sync->getId();
+		pending.order = state.nextOrder ++;
+		pending.fields = std::move(fields);
 	} else {
 		//Combine them
-		//Keep old commands, nothing else
-		event->fields.commands.insert(event->fields.commands.begin(), found->second->fields.commands.begin(), found->second->fields.commands.end());
-		found->second->fields = event->fields;
+		//Keep old commands first, and take the new changes
+		SyncFields &pending = found->second.fields;
+		pending.commands.insert(pending.commands.end(), std::make_move_iterator(fields.commands.begin()), std::make_move_iterator(fields.commands.end()));
+		mergeFields(pending.fields, fields.fields);
+		pending.objectName = fields.objectName;
 #if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Batch create combine:");
-		dumpSyncFields(found->second->fields);
+		TGE::Con::printf("Pending sync combine:");
+		dumpSyncFields(pending);
 #endif
-		delete event;
 	}
+}
 
-	if (shouldPost) {
-		batch->post(object);
-#if DEBUG_SYNC_OBJECTS
-		TGE::Con::printf("Post batch event:");
-		for (const auto &pair : batch->fieldEvents) {
-			dumpSyncFields(pair.second->fields);
-		}
-#endif
+MBX_CONSOLE_METHOD(NetObject, setSyncPriority, void, 3, 3, "obj.setSyncPriority(priority) - Objects with higher priority are synced to clients first. Default is 0.") {
+	SyncId syncId = getSyncId(object->getId(), gServerGhostActiveList);
+	if (syncId == -1) {
+		TGE::Con::errorf("setSyncPriority: %s is not a server sync object", object->getIdString());
+		return;
 	}
+	gSyncPriorities[syncId] = atoi(argv[2]);
+}
+
+MBX_CONSOLE_FUNCTION(setSyncBytesPerTick, void, 2, 2, "setSyncBytesPerTick(bytes) - How much synced object data to send to each client per tick") {
+	gSyncBytesPerTick = std::max(1, atoi(argv[1]));
 }
 
 MBX_CONSOLE_FUNCTION(clearSyncTodo, void, 1, 1, "clearSyncTodo()") {
@@ -948,6 +1357,12 @@ MBX_CONSOLE_FUNCTION(clearSyncTodo, void, 1, 1, "clearSyncTodo()") {
 	gSyncObjectQueuedData.clear();
 }
 
+MBX_CONSOLE_FUNCTION(getSyncFieldStats, const char *, 1, 1, "getSyncFieldStats() - Get \"sent skipped\", how many synced fields were sent and how many were left out because the client already had them") {
+	char *ret = TGE::Con::getReturnBuffer(32);
+	snprintf(ret, 32, "%u %u", gSyncFieldsSent, gSyncFieldsSkipped);
+	return ret;
+}
+
 #if DEBUG_SYNC_OBJECTS
 
 MBX_CONSOLE_FUNCTION(dumpSyncTodo, void, 1, 1, "dumpSyncTodo()") {
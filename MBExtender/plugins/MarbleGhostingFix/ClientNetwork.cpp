@@ -23,6 +23,7 @@
 //-----------------------------------------------------------------------------
 
 #include "MarbleGhostingFix.h"
+#include "Quantize.h"
 #include <MBExtender/MBExtender.h>
 #include <TorqueLib/TypeInfo.h>
 
@@ -117,8 +118,8 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::Marble::unpackUpdate, (TGE::Marble *thisptr, TG
 		Point3D angularVelocity;
 
 		//Read the velocities
-		MathIO::read(stream, &velocity);
-		MathIO::read(stream, &angularVelocity);
+		Quantize::read(stream, &velocity);
+		Quantize::read(stream, &angularVelocity);
 
 		//Only update if it's another marble
 		if (!us) {
@@ -132,7 +133,7 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::Marble::unpackUpdate, (TGE::Marble *thisptr, TG
 	if (stream->readFlag()) {
 		//Read the transform
 		MatrixF mat;
-		MathIO::read(stream, &mat);
+		Quantize::readTransform(stream, &mat);
 
 		//Don't update our local marble's transform-- this is what MBU does and
 		// it becomes jittery and unplayable with any lag.
@@ -145,8 +146,9 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::Marble::unpackUpdate, (TGE::Marble *thisptr, TG
 	//Did we get a camera update?
 	if (stream->readFlag()) {
 		//Read the camera transform
-		EulerF camera;
-		MathIO::read(stream, &camera);
+		F32 values[2];
+		Quantize::readFixed(stream, values, 2);
+		EulerF camera(values[0], values[1], 0);
 
 		//Only update if it's another marble
 		if (!us) {
@@ -159,9 +161,7 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::Marble::unpackUpdate, (TGE::Marble *thisptr, TG
 	//Did we get a gravity update?
 	if (stream->readFlag()) {
 		OrthoF ortho;
-		MathIO::read(stream, &ortho.right);
-		MathIO::read(stream, &ortho.back);
-		MathIO::read(stream, &ortho.down);
+		Quantize::readGravity(stream, &ortho);
 
 		if (!us) {
 			gMarbleData[thisptr->getId()].gravity.ortho = ortho;
@@ -172,7 +172,7 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::Marble::unpackUpdate, (TGE::Marble *thisptr, TG
 	//Did we get a size update?
 	if (stream->readFlag()) {
 		F32 size;
-		MathIO::read(stream, &size);
+		Quantize::readFixed(stream, &size, 1);
 
 		if (!us) {
 			//And apply
@@ -64,6 +64,15 @@ bool MarbleEvent::pack(TGE::NetConnection *connection, TGE::BitStream *stream) {
 	return true;
 }
 
+U32 MarbleEvent::getMaxPackedBits() const {
+	return 5                 //Update flags
+		+ 16 * 32            //Transform
+		+ 2 * 3 * 64         //Velocity and angular velocity
+		+ 3 * 32             //Camera
+		+ 3 * 3 * 32 + 1     //Gravity and gravityInstant
+		+ 32;                //Size
+}
+
 /**
  * Read the event and parse it on the client, but don't actually apply anything
  * yet. That will happen in ::process
@@ -56,6 +56,10 @@ public:
 
 	bool post(TGE::NetConnection *connection, TGE::NetEvent::GuaranteeType guarantee = TGE::NetEvent::GuaranteedOrdered) override;
 	void notifyDelivered(TGE::NetConnection *connection, bool madeIt) override;
+	/**
+	 * [SERVER] Size of the event with every update flag set
+	 */
+	U32 getMaxPackedBits() const override;
 
 	MarbleUpdateInfo &getInfo() {
 		return mInfo;
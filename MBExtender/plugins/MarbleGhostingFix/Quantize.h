@@ -0,0 +1,296 @@
+//-----------------------------------------------------------------------------
+// Quantize.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <MathLib/MathLib.h>
+
+#include <TorqueLib/core/bitStream.h>
+#include <TorqueLib/math/mMathIo.h>
+
+/**
+ * Compact encodings for marble ghost updates. Each encoding writes the bit
+ * counts it used, so only the sender needs to know the precision settings.
+ * Anything that doesn't fit an encoding falls back to full precision.
+ */
+namespace Quantize {
+	//Largest smallest-three component of a unit quaternion, 1/sqrt(2)
+	static const F64 QuatComponentRange = 0.70710678118654752;
+
+	/**
+	 * Get the number of fraction bits for fixed point values.
+	 * @arg maxError The largest error allowed per component.
+	 * @return The number of fraction bits to use.
+	 */
+	inline U32 getFractionBits(F32 maxError) {
+		if (maxError >= 0.5f)
+			return 0;
+		if (maxError <= 0.0f)
+			return 24;
+		S32 bits = static_cast<S32>(ceil(log2(0.5 / maxError)));
+		return static_cast<U32>(mClamp(bits, 0, 24));
+	}
+
+	/**
+	 * Get the number of bits per smallest-three quaternion component.
+	 * @arg maxError The largest error allowed per quaternion component.
+	 * @return The number of bits to use.
+	 */
+	inline U32 getRotationBits(F32 maxError) {
+		if (maxError <= 0.0f)
+			return 30;
+		S32 bits = static_cast<S32>(ceil(log2(QuatComponentRange / maxError + 1.0)));
+		return static_cast<U32>(mClamp(bits, 2, 30));
+	}
+
+	/**
+	 * Write values as fixed point with the fewest integer bits that fit all of
+	 * them. Values too large for 31 bits (or NaN) are written in full.
+	 * @arg stream The stream to write to.
+	 * @arg values The values to write.
+	 * @arg count How many values there are, at most 4.
+	 * @arg fractionBits How many fraction bits to keep.
+	 */
+	template <typename T>
+	inline void writeFixed(TGE::BitStream *stream, const T *values, U32 count, U32 fractionBits) {
+		F64 scale = static_cast<F64>(1 << fractionBits);
+		S64 quantized[4];
+		U64 largest = 0;
+		bool fits = true;
+		for (U32 i = 0; i < count; i ++) {
+			F64 scaled = static_cast<F64>(values[i]) * scale;
+			if (!(fabs(scaled) < 2147483647.0)) {
+				fits = false;
+				break;
+			}
+			quantized[i] = llround(scaled);
+			U64 magnitude = static_cast<U64>(quantized[i] < 0 ? -quantized[i] : quantized[i]);
+			if (magnitude > largest)
+				largest = magnitude;
+		}
+
+		if (stream->writeFlag(fits)) {
+			U32 bits = 0;
+			while ((largest >> bits) != 0) {
+				bits ++;
+			}
+			stream->writeInt(fractionBits, 5);
+			stream->writeInt(bits, 5);
+			for (U32 i = 0; i < count; i ++) {
+				stream->writeFlag(quantized[i] < 0);
+				if (bits > 0) {
+					stream->writeInt(static_cast<S32>(quantized[i] < 0 ? -quantized[i] : quantized[i]), bits);
+				}
+			}
+		} else {
+			for (U32 i = 0; i < count; i ++) {
+				MathIO::write(stream, values[i]);
+			}
+		}
+	}
+
+	template <typename T>
+	inline void readFixed(TGE::BitStream *stream, T *values, U32 count) {
+		if (stream->readFlag()) {
+			U32 fractionBits = stream->readInt(5);
+			U32 bits = stream->readInt(5);
+			F64 scale = static_cast<F64>(1 << fractionBits);
+			for (U32 i = 0; i < count; i ++) {
+				bool negative = stream->readFlag();
+				F64 magnitude = (bits > 0 ? static_cast<F64>(static_cast<U32>(stream->readInt(bits))) : 0.0);
+				values[i] = static_cast<T>((negative ? -magnitude : magnitude) / scale);
+			}
+		} else {
+			for (U32 i = 0; i < count; i ++) {
+				MathIO::read(stream, &values[i]);
+			}
+		}
+	}
+
+	inline void write(TGE::BitStream *stream, const Point3D &value, U32 fractionBits) {
+		F64 values[3] = {value.x, value.y, value.z};
+		writeFixed(stream, values, 3, fractionBits);
+	}
+	inline void read(TGE::BitStream *stream, Point3D *value) {
+		F64 values[3];
+		readFixed(stream, values, 3);
+		value->set(values[0], values[1], values[2]);
+	}
+	inline void write(TGE::BitStream *stream, const Point3F &value, U32 fractionBits) {
+		F32 values[3] = {value.x, value.y, value.z};
+		writeFixed(stream, values, 3, fractionBits);
+	}
+	inline void read(TGE::BitStream *stream, Point3F *value) {
+		F32 values[3];
+		readFixed(stream, values, 3);
+		value->set(values[0], values[1], values[2]);
+	}
+
+	/**
+	 * Write a transform as a fixed point position and a smallest-three
+	 * quaternion. Matrices that aren't a rotation and a translation (scaled or
+	 * skewed) are written in full.
+	 * @arg stream The stream to write to.
+	 * @arg mat The transform to write.
+	 * @arg fractionBits Fraction bits for the position.
+	 * @arg rotationBits Bits per quaternion component.
+	 */
+	inline void writeTransform(TGE::BitStream *stream, const MatrixF &mat, U32 fractionBits, U32 rotationBits) {
+		Point3F x = mat.getColumn3F(0);
+		Point3F y = mat.getColumn3F(1);
+		Point3F z = mat.getColumn3F(2);
+		bool rigid = mFabs(x.lenSquared() - 1.0f) < 0.001f
+			&& mFabs(y.lenSquared() - 1.0f) < 0.001f
+			&& mFabs(z.lenSquared() - 1.0f) < 0.001f
+			&& mFabs(mDot(x, y)) < 0.001f
+			&& mFabs(mDot(y, z)) < 0.001f
+			&& mFabs(mDot(z, x)) < 0.001f
+			&& mDot(mCross(x, y), z) > 0.0f
+			&& mat.m[12] == 0.0f && mat.m[13] == 0.0f && mat.m[14] == 0.0f && mat.m[15] == 1.0f;
+
+		if (!stream->writeFlag(rigid)) {
+			MathIO::write(stream, mat);
+			return;
+		}
+
+		write(stream, mat.getPosition(), fractionBits);
+
+		QuatF quat(mat);
+		quat.normalize();
+		F32 components[4] = {quat.x, quat.y, quat.z, quat.w};
+
+		//Drop the largest component, the decoder works it out from the rest
+		U32 largest = 0;
+		for (U32 i = 1; i < 4; i ++) {
+			if (mFabs(components[i]) > mFabs(components[largest]))
+				largest = i;
+		}
+		//q and -q are the same rotation, so make the dropped one positive
+		F32 sign = (components[largest] < 0.0f ? -1.0f : 1.0f);
+
+		U32 maxValue = (1U << rotationBits) - 1;
+		stream->writeInt(largest, 2);
+		stream->writeInt(rotationBits, 5);
+		for (U32 i = 0; i < 4; i ++) {
+			if (i == largest)
+				continue;
+			F64 normalized = (components[i] * sign + QuatComponentRange) / (2.0 * QuatComponentRange);
+			S64 value = llround(normalized * maxValue);
+			if (value < 0)
+				value = 0;
+			if (value > maxValue)
+				value = maxValue;
+			stream->writeInt(static_cast<S32>(value), rotationBits);
+		}
+	}
+
+	inline void readTransform(TGE::BitStream *stream, MatrixF *mat) {
+		if (!stream->readFlag()) {
+			MathIO::read(stream, mat);
+			return;
+		}
+
+		Point3F position;
+		read(stream, &position);
+
+		U32 largest = stream->readInt(2);
+		U32 rotationBits = stream->readInt(5);
+		U32 maxValue = (1U << rotationBits) - 1;
+		F32 components[4];
+		F32 sum = 0.0f;
+		for (U32 i = 0; i < 4; i ++) {
+			if (i == largest)
+				continue;
+			U32 value = static_cast<U32>(stream->readInt(rotationBits));
+			components[i] = static_cast<F32>(static_cast<F64>(value) / maxValue * (2.0 * QuatComponentRange) - QuatComponentRange);
+			sum += components[i] * components[i];
+		}
+		components[largest] = mSqrt(getMax(0.0f, 1.0f - sum));
+
+		QuatF quat(components[0], components[1], components[2], components[3]);
+		quat.normalize();
+		quat.setMatrix(mat);
+		mat->setPosition(position);
+	}
+
+	/**
+	 * Get which axis direction a vector is, if it's within maxError of one.
+	 * @return The axis times two, plus one if it's negative, or -1.
+	 */
+	inline S32 getAxisIndex(const Point3F &vector, F32 maxError) {
+		F32 components[3] = {vector.x, vector.y, vector.z};
+		for (U32 axis = 0; axis < 3; axis ++) {
+			bool aligned = mFabs(mFabs(components[axis]) - 1.0f) <= maxError;
+			for (U32 other = 0; aligned && other < 3; other ++) {
+				if (other != axis && mFabs(components[other]) > maxError)
+					aligned = false;
+			}
+			if (aligned)
+				return static_cast<S32>(axis * 2 + (components[axis] < 0.0f ? 1 : 0));
+		}
+		return -1;
+	}
+
+	inline Point3F getAxis(U32 index) {
+		F32 components[3] = {0.0f, 0.0f, 0.0f};
+		components[(index / 2) % 3] = ((index & 1) ? -1.0f : 1.0f);
+		return Point3F(components[0], components[1], components[2]);
+	}
+
+	/**
+	 * Write a gravity orientation. Axis-aligned gravity, which is almost all of
+	 * it, is just three axis indices.
+	 * @arg stream The stream to write to.
+	 * @arg gravity The gravity orientation to write.
+	 * @arg fractionBits Fraction bits for gravity that isn't axis-aligned.
+	 * @arg maxError How far from an axis a vector can be and still count.
+	 */
+	inline void writeGravity(TGE::BitStream *stream, const OrthoF &gravity, U32 fractionBits, F32 maxError) {
+		S32 right = getAxisIndex(gravity.right, maxError);
+		S32 back = getAxisIndex(gravity.back, maxError);
+		S32 down = getAxisIndex(gravity.down, maxError);
+		if (stream->writeFlag(right != -1 && back != -1 && down != -1)) {
+			stream->writeInt(right, 3);
+			stream->writeInt(back, 3);
+			stream->writeInt(down, 3);
+		} else {
+			write(stream, gravity.right, fractionBits);
+			write(stream, gravity.back, fractionBits);
+			write(stream, gravity.down, fractionBits);
+		}
+	}
+
+	inline void readGravity(TGE::BitStream *stream, OrthoF *gravity) {
+		if (stream->readFlag()) {
+			gravity->right = getAxis(stream->readInt(3));
+			gravity->back = getAxis(stream->readInt(3));
+			gravity->down = getAxis(stream->readInt(3));
+		} else {
+			read(stream, &gravity->right);
+			read(stream, &gravity->back);
+			read(stream, &gravity->down);
+		}
+	}
+}
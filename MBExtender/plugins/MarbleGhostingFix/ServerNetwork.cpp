@@ -26,11 +26,50 @@
 #include <MBExtender/MBExtender.h>
 #include <TorqueLib/TypeInfo.h>
 #include "MarbleEvent.h"
+#include "Quantize.h"
 
 #include <TorqueLib/game/gameConnection.h>
 
+#ifdef _WIN32
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#endif
+
 MBX_MODULE(ServerNetwork);
 
+//Largest error allowed in each part of the marble updates sent to clients
+struct GhostPrecision {
+	const char *name;
+	F32 maxError;
+};
+static GhostPrecision gGhostPrecision[] = {
+	{"position",        0.0005f},
+	{"rotation",        0.0002f},
+	{"velocity",        0.0005f},
+	{"angularVelocity", 0.0005f},
+	{"camera",          0.0001f},
+	{"gravity",         0.0001f},
+	{"size",            0.0001f},
+};
+enum GhostPrecisionField {
+	PositionPrecision,
+	RotationPrecision,
+	VelocityPrecision,
+	AngularVelocityPrecision,
+	CameraPrecision,
+	GravityPrecision,
+	SizePrecision,
+};
+
+//For getMarbleGhostStats()
+static U32 gGhostUpdates = 0;
+static U64 gGhostUpdateBytes = 0;
+
+static U32 getFractionBits(GhostPrecisionField field) {
+	return Quantize::getFractionBits(gGhostPrecision[field].maxError);
+}
+
 /**
  * Client->Server marble update sending. This is on the server, receiving ghost
  * marble updates from the client.
@@ -142,6 +181,7 @@ MBX_OVERRIDE_MEMBERFN(void, TGE::MarbleUpdateEvent::unpack, (TGE::MarbleUpdateEv
  */
 MBX_OVERRIDE_MEMBERFN(U32, TGE::Marble::packUpdate, (TGE::Marble *thisptr, TGE::NetConnection *connection, U32 mask, TGE::BitStream *stream), originalPackUpdate) {
 	U32 ret = originalPackUpdate(thisptr, connection, mask, stream);
+	U32 start = stream->getPosition();
 
 	//Which things need to be updated from script?
 	U32 forceFlags = gMarbleUpdates[thisptr->getId()].types;
@@ -159,8 +199,8 @@ MBX_OVERRIDE_MEMBERFN(U32, TGE::Marble::packUpdate, (TGE::Marble *thisptr, TGE::
 		}
 
 		//And write them to the client
-		MathIO::write(stream, velocity);
-		MathIO::write(stream, angularVelocity);
+		Quantize::write(stream, velocity, getFractionBits(VelocityPrecision));
+		Quantize::write(stream, angularVelocity, getFractionBits(AngularVelocityPrecision));
 	}
 	//Should we send a transform update?
 	if (stream->writeFlag((mask & TransformMask) == TransformMask)) {
@@ -172,7 +212,8 @@ MBX_OVERRIDE_MEMBERFN(U32, TGE::Marble::packUpdate, (TGE::Marble *thisptr, TGE::
 		}
 
 		//And write them to the client
-		MathIO::write(stream, mat);
+		Quantize::writeTransform(stream, mat, getFractionBits(PositionPrecision),
+			Quantize::getRotationBits(gGhostPrecision[RotationPrecision].maxError));
 	}
 	//Should we send camera updates?
 	if (stream->writeFlag((mask & CameraMask) == CameraMask)) {
@@ -183,17 +224,15 @@ MBX_OVERRIDE_MEMBERFN(U32, TGE::Marble::packUpdate, (TGE::Marble *thisptr, TGE::
 			camera = gMarbleUpdates[thisptr->getId()].camera;
 		}
 
-		//And write them to the client
-		MathIO::write(stream, camera);
+		//And write them to the client, roll is always 0
+		F32 values[2] = {camera.x, camera.y};
+		Quantize::writeFixed(stream, values, 2, getFractionBits(CameraPrecision));
 	}
 	//Should we send gravity updates?
 	if (stream->writeFlag((mask & GravityMask) == GravityMask)) {
 		//Get gravity updates from the saved data
 		OrthoF gravity = gMarbleData[thisptr->getId()].gravity.ortho;
-		//Write gravity in three parts
-		MathIO::write(stream, gravity.right);
-		MathIO::write(stream, gravity.back);
-		MathIO::write(stream, gravity.down);
+		Quantize::writeGravity(stream, gravity, getFractionBits(GravityPrecision), gGhostPrecision[GravityPrecision].maxError);
 	}
 	//Should we send size updates?
 	if (stream->writeFlag((mask & SizeMask) == SizeMask)) {
@@ -203,12 +242,16 @@ MBX_OVERRIDE_MEMBERFN(U32, TGE::Marble::packUpdate, (TGE::Marble *thisptr, TGE::
 			size = gMarbleUpdates[thisptr->getId()].size;
 		}
 		//Write the size
-		MathIO::write(stream, size);
+		Quantize::writeFixed(stream, &size, 1, getFractionBits(SizePrecision));
 	}
 
 	//Just always send controllable
 	stream->writeFlag(thisptr->getControllable());
 
+	gGhostUpdates ++;
+	//getPosition() is a byte offset
+	gGhostUpdateBytes += stream->getPosition() - start;
+
 	//Don't clear the flags unless they're sent to ourselves
 	if (forceFlags && thisptr->getControllingClient() == connection) {
 		//Send the data to our client, but reliably
@@ -226,3 +269,19 @@ void MarbleUpdateInfo::writePacket(TGE::GameConnection *connection) {
 	event->post(connection);
 	reset();
 }
+
+MBX_CONSOLE_FUNCTION(setMarbleGhostPrecision, void, 3, 3, "setMarbleGhostPrecision(field, maxError) - Set the largest error allowed in marble updates sent to clients. Fields are position, rotation, velocity, angularVelocity, camera, gravity and size.") {
+	for (GhostPrecision &precision : gGhostPrecision) {
+		if (strcasecmp(precision.name, argv[1]) == 0) {
+			precision.maxError = StringMath::scan<F32>(argv[2]);
+			return;
+		}
+	}
+	TGE::Con::errorf("setMarbleGhostPrecision: Unknown field %s", argv[1]);
+}
+
+MBX_CONSOLE_FUNCTION(getMarbleGhostStats, const char *, 1, 1, "getMarbleGhostStats() - Get \"updates bytes\" for the MBP part of marble updates sent to clients") {
+	char *ret = TGE::Con::getReturnBuffer(64);
+	snprintf(ret, 64, "%u %llu", gGhostUpdates, static_cast<unsigned long long>(gGhostUpdateBytes));
+	return ret;
+}
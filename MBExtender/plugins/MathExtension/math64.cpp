@@ -23,7 +23,11 @@
 /// These functions let us do big math in TorqueScript without
 /// losing precision :D
 
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include <MBExtender/MBExtender.h>
 #include <TorqueLib/console/console.h>
@@ -37,51 +41,467 @@
 
 MBX_MODULE(Math64);
 
+//Longest string any of the number formatters can produce, plus a separator
+#define MAX_NUMBER_LENGTH 32
+
+//Powers of ten that are exactly representable as doubles
+static const F64 gExactPowersOfTen[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isSeparator(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\n';
+}
+
+static inline bool isDigit(char ch) {
+	return ch >= '0' && ch <= '9';
+}
+
+/**
+ * Parse a decimal integer. Anything after the number is ignored.
+ * @arg str The string to parse. Advanced past the number.
+ * @arg out The parsed value. Saturates on overflow.
+ * @return False if the number did not fit in an S64.
+ */
+static bool parseNumber(const char *&str, S64 &out) {
+	const char *pos = str;
+	while (isSeparator(*pos))
+		pos++;
+
+	bool negative = (*pos == '-');
+	if (*pos == '-' || *pos == '+')
+		pos++;
+
+	//Magnitude is accumulated unsigned so S64_MIN can be parsed
+	U64 limit = negative ? U64(INT64_MAX) + 1 : U64(INT64_MAX);
+	U64 value = 0;
+	bool overflow = false;
+	for (; isDigit(*pos); pos++) {
+		U32 digit = *pos - '0';
+		if (value > (limit - digit) / 10) {
+			overflow = true;
+			value = limit;
+		} else if (!overflow) {
+			value = value * 10 + digit;
+		}
+	}
+
+	out = negative ? S64(0 - value) : S64(value);
+	str = pos;
+	return !overflow;
+}
+
+/**
+ * Parse a decimal floating point number. Numbers with up to 15 significant
+ * digits and small exponents are converted exactly without going through
+ * strtod, everything else (long mantissas, inf, nan) falls back to it.
+ * @arg str The string to parse. Advanced past the number.
+ * @arg out The parsed value, 0 if there is no number.
+ * @return True, doubles don't overflow.
+ */
+static bool parseNumber(const char *&str, F64 &out) {
+	const char *pos = str;
+	while (isSeparator(*pos))
+		pos++;
+	const char *start = pos;
+
+	bool negative = (*pos == '-');
+	if (*pos == '-' || *pos == '+')
+		pos++;
+
+	U64 mantissa = 0;
+	S32 digits = 0;
+	S32 exponent = 0;
+	bool anyDigits = false;
+
+	for (; isDigit(*pos); pos++) {
+		anyDigits = true;
+		if (mantissa == 0 && *pos == '0')
+			continue;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*pos - '0');
+		} else {
+			exponent++;
+		}
+		digits++;
+	}
+	if (*pos == '.') {
+		for (pos++; isDigit(*pos); pos++) {
+			anyDigits = true;
+			if (mantissa == 0 && *pos == '0') {
+				exponent--;
+				continue;
+			}
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*pos - '0');
+				exponent--;
+			}
+			digits++;
+		}
+	}
+	if (anyDigits && (*pos == 'e' || *pos == 'E')) {
+		const char *expPos = pos + 1;
+		bool expNegative = (*expPos == '-');
+		if (*expPos == '-' || *expPos == '+')
+			expPos++;
+		if (isDigit(*expPos)) {
+			S32 explicitExponent = 0;
+			for (; isDigit(*expPos); expPos++) {
+				if (explicitExponent < 100000)
+					explicitExponent = explicitExponent * 10 + (*expPos - '0');
+			}
+			exponent += expNegative ? -explicitExponent : explicitExponent;
+			pos = expPos;
+		}
+	}
+
+	//Exact when both the mantissa and the power of ten are exact doubles,
+	// since a single multiply or divide is correctly rounded
+	if (anyDigits && digits <= 15 && exponent >= -22 && exponent <= 22) {
+		F64 value = F64(mantissa);
+		if (exponent < 0)
+			value /= gExactPowersOfTen[-exponent];
+		else
+			value *= gExactPowersOfTen[exponent];
+		out = negative ? -value : value;
+		str = pos;
+		return true;
+	}
+
+	char *end;
+	out = strtod(start, &end);
+	str = (end == start ? pos : end);
+	return true;
+}
+
+/**
+ * Format an integer.
+ * @arg buffer Output, must hold MAX_NUMBER_LENGTH chars.
+ * @return The number of characters written, not including the terminator.
+ */
+static U32 formatNumber(char *buffer, S64 value) {
+	char digits[MAX_NUMBER_LENGTH];
+	char *digit = digits + sizeof(digits);
+
+	U64 magnitude = (value < 0) ? 0 - U64(value) : U64(value);
+	do {
+		*--digit = '0' + (magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (value < 0)
+		*--digit = '-';
+
+	U32 length = U32(digits + sizeof(digits) - digit);
+	memcpy(buffer, digit, length);
+	buffer[length] = 0;
+	return length;
+}
+
+/**
+ * Format a double with the fewest digits that still parse back to the same
+ * value.
+ * @arg buffer Output, must hold MAX_NUMBER_LENGTH chars.
+ * @return The number of characters written, not including the terminator.
+ */
+static U32 formatNumber(char *buffer, F64 value) {
+	//Whole numbers are the common case and the integer formatter is exact
+	if (value == floor(value) && fabs(value) < 1e15) {
+		return formatNumber(buffer, S64(value));
+	}
+
+	int length = snprintf(buffer, MAX_NUMBER_LENGTH, "%.15g", value);
+	if (strtod(buffer, NULL) != value) {
+		length = snprintf(buffer, MAX_NUMBER_LENGTH, "%.17g", value);
+	}
+	return U32(length);
+}
+
+template<typename T>
+static const char *formatResult(T value) {
+	char *ret = TGE::Con::getReturnBuffer(MAX_NUMBER_LENGTH);
+	formatNumber(ret, value);
+	return ret;
+}
+
+static U32 countWords(const char *list) {
+	U32 count = 0;
+	const char *pos = list;
+	while (*pos != 0) {
+		while (isSeparator(*pos))
+			pos++;
+		if (*pos == 0)
+			break;
+		count++;
+		while (*pos != 0 && !isSeparator(*pos))
+			pos++;
+	}
+	return count;
+}
+
+//Parse the next word of a list, skipping anything in the word that isn't part
+// of the number
+template<typename T>
+static bool parseWord(const char *&pos, T &out) {
+	bool ok = parseNumber(pos, out);
+	while (*pos != 0 && !isSeparator(*pos))
+		pos++;
+	return ok;
+}
+
+/**
+ * Apply a binary op to every word of a list. The second list can either have
+ * the same number of words as the first, or a single word that is used for
+ * every element.
+ * @return A space-separated list of the results, or "" on a length mismatch.
+ */
+template<typename T>
+static const char *applyList(const char *name, const char *listA, const char *listB, bool (*op)(T, T, T &)) {
+	U32 countA = countWords(listA);
+	U32 countB = countWords(listB);
+	if (countB != countA && countB != 1) {
+		TGE::Con::errorf("%s: Lists have different lengths (%d and %d)", name, countA, countB);
+		return "";
+	}
+	char *ret = TGE::Con::getReturnBuffer(countA * MAX_NUMBER_LENGTH + 1);
+	char *out = ret;
+	*out = 0;
+
+	const char *posA = listA;
+	const char *posB = listB;
+	T b = 0;
+	bool overflow = false;
+	bool divideByZero = false;
+	if (countB == 1)
+		overflow |= !parseWord(posB, b);
+
+	for (U32 i = 0; i < countA; i++) {
+		T a;
+		overflow |= !parseWord(posA, a);
+		if (countB != 1)
+			overflow |= !parseWord(posB, b);
+		if (!op(a, b, a)) {
+			//Ops only fail with b == 0 when dividing by it
+			if (b == 0)
+				divideByZero = true;
+			else
+				overflow = true;
+		}
+
+		if (i != 0)
+			*out++ = ' ';
+		out += formatNumber(out, a);
+	}
+	if (overflow)
+		TGE::Con::errorf("%s: Integer overflow", name);
+	if (divideByZero)
+		TGE::Con::errorf("%s: Division by zero", name);
+	return ret;
+}
+
 /**
- * Used for defining a new floating point math64 function.
+ * Apply a unary op to every word of a list.
+ * @return A space-separated list of the results.
+ */
+static const char *applyList(const char *list, F64 (*op)(F64)) {
+	U32 count = countWords(list);
+	char *ret = TGE::Con::getReturnBuffer(count * MAX_NUMBER_LENGTH + 1);
+	char *out = ret;
+	*out = 0;
+
+	const char *pos = list;
+	for (U32 i = 0; i < count; i++) {
+		F64 a;
+		parseWord(pos, a);
+		if (i != 0)
+			*out++ = ' ';
+		out += formatNumber(out, op(a));
+	}
+	return ret;
+}
+
+/**
+ * Used for defining a new floating point math64 function. Also defines a
+ * name_list variant which operates on space-separated lists.
  * @arg name The name of the function.
  * @arg expr The expression to evaluate for the function.
  */
 #define math64(name, expr) \
+static bool name##Op(F64 a, F64 b, F64 &result) { \
+	expr; \
+	result = a; \
+	return true; \
+} \
 MBX_CONSOLE_FUNCTION(name, const char*, 3, 3, #name "(a, b)") { \
-	F64 a;\
-	F64 b;\
-	sscanf(argv[1], "%lf", &a);\
-	sscanf(argv[2], "%lf", &b);\
-	expr;\
-	char* ret = TGE::Con::getReturnBuffer(64);\
-	sprintf(ret, "%.7g", a);\
-	return ret;\
+	F64 a; \
+	F64 b; \
+	const char *posA = argv[1]; \
+	const char *posB = argv[2]; \
+	parseNumber(posA, a); \
+	parseNumber(posB, b); \
+	name##Op(a, b, a); \
+	return formatResult(a); \
+} \
+MBX_CONSOLE_FUNCTION(name##_list, const char*, 3, 3, #name "_list(a, b) - b may be a list or a single number") { \
+	return applyList<F64>(#name "_list", argv[1], argv[2], name##Op); \
 }
 
 /**
  * Used for defining a new rounding math64 function (only takes one argument).
+ * Also defines a name_list variant which operates on a space-separated list.
  * @arg name The name of the function.
  * @arg expr The expression to evaluate for the function.
  */
 #define round64(name, expr) \
+static F64 name##Op(F64 a) { \
+	expr; \
+	return a; \
+} \
 MBX_CONSOLE_FUNCTION(name, const char*, 2, 2, #name "(a)") { \
 	F64 a; \
-	sscanf(argv[1], "%lf", &a);\
-	expr; \
-	char* ret = TGE::Con::getReturnBuffer(64); \
-	sprintf(ret, "%.7g", a); \
-	return ret; \
+	const char *pos = argv[1]; \
+	parseNumber(pos, a); \
+	return formatResult(name##Op(a)); \
+} \
+MBX_CONSOLE_FUNCTION(name##_list, const char*, 2, 2, #name "_list(a)") { \
+	return applyList(argv[1], name##Op); \
 }
 
 /**
- * Used for defining a new integer math64 function.
+ * Used for defining a new integer math64 function. Also defines a name_list
+ * variant which operates on space-separated lists.
  * @arg name The name of the function.
- * @arg expr The expression to evaluate for the function.
+ * @arg op A function which computes the result and returns false on overflow
+ *         or division by zero.
  */
-#define math64_int(name, expr) \
+#define math64_int(name, op) \
 MBX_CONSOLE_FUNCTION(name, const char*, 3, 3, #name "(a, b)") { \
-	S64 a = (S64)atoll(argv[1]); \
-	S64 b = (S64)atoll(argv[2]); \
-	expr; \
-	char* ret = TGE::Con::getReturnBuffer(64); \
-	sprintf(ret, "%lld", a); \
-	return ret; \
+	S64 a; \
+	S64 b; \
+	const char *posA = argv[1]; \
+	const char *posB = argv[2]; \
+	bool ok = parseNumber(posA, a); \
+	ok = parseNumber(posB, b) && ok; \
+	if (!op(a, b, a)) { \
+		if (b == 0) \
+			TGE::Con::errorf(#name ": Division by zero"); \
+		else \
+			ok = false; \
+	} \
+	if (!ok) \
+		TGE::Con::errorf(#name ": Integer overflow"); \
+	return formatResult(a); \
+} \
+MBX_CONSOLE_FUNCTION(name##_list, const char*, 3, 3, #name "_list(a, b) - b may be a list or a single number") { \
+	return applyList<S64>(#name "_list", argv[1], argv[2], op); \
+}
+
+/**
+ * Checked integer operations. On overflow these saturate and return false.
+ * Division and modulus by zero return 0 and false.
+ */
+static bool addInt(S64 a, S64 b, S64 &result) {
+	if (b > 0 && a > INT64_MAX - b) {
+		result = INT64_MAX;
+		return false;
+	}
+	if (b < 0 && a < INT64_MIN - b) {
+		result = INT64_MIN;
+		return false;
+	}
+	result = a + b;
+	return true;
+}
+
+static bool subInt(S64 a, S64 b, S64 &result) {
+	if (b < 0 && a > INT64_MAX + b) {
+		result = INT64_MAX;
+		return false;
+	}
+	if (b > 0 && a < INT64_MIN + b) {
+		result = INT64_MIN;
+		return false;
+	}
+	result = a - b;
+	return true;
+}
+
+static bool multInt(S64 a, S64 b, S64 &result) {
+	if (a == 0 || b == 0) {
+		result = 0;
+		return true;
+	}
+	U64 magA = (a < 0) ? 0 - U64(a) : U64(a);
+	U64 magB = (b < 0) ? 0 - U64(b) : U64(b);
+	bool negative = (a < 0) != (b < 0);
+	U64 limit = negative ? U64(INT64_MAX) + 1 : U64(INT64_MAX);
+	if (magA > limit / magB) {
+		result = negative ? INT64_MIN : INT64_MAX;
+		return false;
+	}
+	U64 magnitude = magA * magB;
+	result = negative ? S64(0 - magnitude) : S64(magnitude);
+	return true;
+}
+
+static bool divInt(S64 a, S64 b, S64 &result) {
+	if (b == 0) {
+		//Used to crash the game
+		result = 0;
+		return false;
+	}
+	if (a == INT64_MIN && b == -1) {
+		result = INT64_MAX;
+		return false;
+	}
+	result = a / b;
+	return true;
+}
+
+static bool modInt(S64 a, S64 b, S64 &result) {
+	if (b == 0) {
+		result = 0;
+		return false;
+	}
+	//INT64_MIN % -1 traps on x86
+	result = (b == -1 ? 0 : a % b);
+	return true;
+}
+
+static bool powInt(S64 a, S64 b, S64 &result) {
+	if (b < 0) {
+		//Only 1 and -1 have integer reciprocals, everything else truncates to 0
+		if (a == 1 || (a == -1 && (b & 1) == 0))
+			result = 1;
+		else if (a == -1)
+			result = -1;
+		else
+			result = 0;
+		return a != 0;
+	}
+	//Exponentiation by squaring, stays exact unlike going through pow()
+	S64 value = 1;
+	S64 base = a;
+	bool ok = true;
+	while (b != 0) {
+		if (b & 1)
+			ok = multInt(value, base, value) && ok;
+		b >>= 1;
+		if (b != 0)
+			ok = multInt(base, base, base) && ok;
+	}
+	result = value;
+	return ok;
+}
+
+static bool maxInt(S64 a, S64 b, S64 &result) {
+	result = (a > b ? a : b);
+	return true;
+}
+
+static bool minInt(S64 a, S64 b, S64 &result) {
+	result = (a > b ? b : a);
+	return true;
 }
 
 /**
@@ -122,12 +542,12 @@ round64(round64, a = round(a));
  *  - Exponentiation
  *  - Modulus
  */
-math64_int(add64_int, a += b);
-math64_int(sub64_int, a -= b);
-math64_int(mult64_int, a *= b);
-math64_int(div64_int, a /= b);
-math64_int(pow64_int, a = (S64)pow(a, b));
-math64_int(mod64_int, a = (S64)fmod(a, b));
-
-math64_int(max64_int, a = (a > b ? a : b));
-math64_int(min64_int, a = (a > b ? b : a));
+math64_int(add64_int, addInt);
+math64_int(sub64_int, subInt);
+math64_int(mult64_int, multInt);
+math64_int(div64_int, divInt);
+math64_int(pow64_int, powInt);
+math64_int(mod64_int, modInt);
+
+math64_int(max64_int, maxInt);
+math64_int(min64_int, minInt);
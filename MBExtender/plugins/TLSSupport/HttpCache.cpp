@@ -0,0 +1,338 @@
+//-----------------------------------------------------------------------------
+// HttpCache.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "HttpCache.h"
+#include "TLSSupport.h"
+#include <MathLib/MathLib.h>
+#include <curl/curl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <TorqueLib/console/console.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/utime.h>
+#define utime _utime
+#define utimbuf _utimbuf
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+MBX_MODULE(HttpCache);
+
+namespace HttpCache {
+	static const char *gMagic = "MBXHTTPCACHE 2";
+
+	static bool gEnabled = false;
+	static std::string gDirectory;
+	static U64 gMaxSize = 0;
+	static U64 gTotalSize = 0;
+
+	//Most recently used first
+	struct IndexEntry {
+		std::string key;
+		U64 size;
+	};
+	static std::list<IndexEntry> gLru;
+	static std::unordered_map<std::string, std::list<IndexEntry>::iterator> gIndex;
+
+	static U32 gHits = 0;
+	static U32 gMisses = 0;
+	static U32 gRevalidations = 0;
+	static U32 gStores = 0;
+	static U32 gEvictions = 0;
+
+	bool isEnabled() {
+		return gEnabled;
+	}
+
+	void countHit() {
+		gHits++;
+	}
+
+	void countMiss() {
+		gMisses++;
+	}
+
+	void countRevalidation() {
+		gRevalidations++;
+	}
+
+	/**
+	 * Entries are stored under a hash of the URL. FNV-1a, since the name has
+	 * to stay the same between runs and builds.
+	 */
+	static std::string getKey(const std::string &url) {
+		U64 hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < url.size(); i++) {
+			hash ^= static_cast<U8>(url[i]);
+			hash *= 1099511628211ULL;
+		}
+		char key[17];
+		snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+		return key;
+	}
+
+	static std::string getPath(const std::string &key) {
+		return gDirectory + "/" + key + ".cache";
+	}
+
+	static void removeEntry(std::unordered_map<std::string, std::list<IndexEntry>::iterator>::iterator it) {
+		remove(getPath(it->first).c_str());
+		gTotalSize -= it->second->size;
+		gLru.erase(it->second);
+		gIndex.erase(it);
+	}
+
+	static void evict() {
+		while (gTotalSize > gMaxSize && !gLru.empty()) {
+			removeEntry(gIndex.find(gLru.back().key));
+			gEvictions++;
+		}
+	}
+
+	static void markUsed(const std::string &key) {
+		auto it = gIndex.find(key);
+		if (it == gIndex.end())
+			return;
+		gLru.splice(gLru.begin(), gLru, it->second);
+
+		//The file's modification time is the LRU order between runs
+		utime(getPath(key).c_str(), NULL);
+	}
+
+	/**
+	 * Rebuild the index from the files in the cache directory.
+	 */
+	static void scanDirectory() {
+		struct FoundEntry {
+			std::string key;
+			U64 size;
+			time_t modified;
+		};
+		std::vector<FoundEntry> found;
+
+		auto addFile = [&found](const char *name) {
+			size_t length = strlen(name);
+			if (length != 16 + 6 || strcmp(name + 16, ".cache") != 0)
+				return;
+			struct stat st;
+			std::string key(name, 16);
+			if (stat(getPath(key).c_str(), &st) != 0)
+				return;
+			found.push_back(FoundEntry{key, static_cast<U64>(st.st_size), st.st_mtime});
+		};
+
+#ifdef _WIN32
+		WIN32_FIND_DATAA file;
+		HANDLE find = FindFirstFileA((gDirectory + "/*.cache").c_str(), &file);
+		if (find != INVALID_HANDLE_VALUE) {
+			do {
+				addFile(file.cFileName);
+			} while (FindNextFileA(find, &file));
+			FindClose(find);
+		}
+#else
+		DIR *dir = opendir(gDirectory.c_str());
+		if (dir != NULL) {
+			struct dirent *file;
+			while ((file = readdir(dir)) != NULL) {
+				addFile(file->d_name);
+			}
+			closedir(dir);
+		}
+#endif
+
+		//Oldest last
+		std::sort(found.begin(), found.end(), [](const FoundEntry &a, const FoundEntry &b) {
+			return a.modified > b.modified;
+		});
+
+		gLru.clear();
+		gIndex.clear();
+		gTotalSize = 0;
+		for (const FoundEntry &entry : found) {
+			gLru.push_back(IndexEntry{entry.key, entry.size});
+			gIndex[entry.key] = std::prev(gLru.end());
+			gTotalSize += entry.size;
+		}
+	}
+
+	bool getExpiry(const char *cacheControl, const char *expiresHeader, time_t now, time_t &expires) {
+		expires = now;
+
+		if (cacheControl != NULL) {
+			std::string directives(cacheControl);
+			std::transform(directives.begin(), directives.end(), directives.begin(), ::tolower);
+
+			if (directives.find("no-store") != std::string::npos)
+				return false;
+			//Can be stored, but always has to be revalidated
+			if (directives.find("no-cache") != std::string::npos)
+				return true;
+
+			size_t maxAge = directives.find("max-age=");
+			if (maxAge != std::string::npos) {
+				expires = now + atol(directives.c_str() + maxAge + 8);
+				return true;
+			}
+		}
+
+		if (expiresHeader != NULL) {
+			time_t date = curl_getdate(expiresHeader, NULL);
+			if (date > now)
+				expires = date;
+		}
+		return true;
+	}
+
+	static bool readLine(FILE *file, std::string &line) {
+		line.clear();
+		int ch;
+		while ((ch = fgetc(file)) != EOF && ch != '\n') {
+			line += static_cast<char>(ch);
+		}
+		return ch != EOF;
+	}
+
+	bool load(const std::string &url, Entry &entry) {
+		if (!gEnabled)
+			return false;
+		std::string key = getKey(url);
+		if (gIndex.find(key) == gIndex.end())
+			return false;
+
+		FILE *file = fopen(getPath(key).c_str(), "rb");
+		if (file == NULL)
+			return false;
+
+		std::string magic, storedUrl, expires, size;
+		bool valid = readLine(file, magic) && magic == gMagic
+			&& readLine(file, storedUrl) && storedUrl == url
+			&& readLine(file, entry.etag)
+			&& readLine(file, entry.lastModified)
+			&& readLine(file, entry.contentType)
+			&& readLine(file, expires)
+			&& readLine(file, size);
+		if (valid) {
+			entry.expires = static_cast<time_t>(strtoll(expires.c_str(), NULL, 10));
+			entry.body.resize(strtoul(size.c_str(), NULL, 10));
+			valid = entry.body.empty() || fread(&entry.body[0], 1, entry.body.size(), file) == entry.body.size();
+		}
+		fclose(file);
+
+		if (!valid) {
+			//Corrupt, or a different URL with the same hash
+			return false;
+		}
+
+		markUsed(key);
+		return true;
+	}
+
+	void store(const std::string &url, const Entry &entry) {
+		if (!gEnabled)
+			return;
+		std::string key = getKey(url);
+		std::string path = getPath(key);
+		std::string tempPath = path + ".tmp";
+
+		FILE *file = fopen(tempPath.c_str(), "wb");
+		if (file == NULL)
+			return;
+		fprintf(file, "%s\n%s\n%s\n%s\n%s\n%lld\n%u\n", gMagic, url.c_str(), entry.etag.c_str(), entry.lastModified.c_str(),
+			entry.contentType.c_str(),
+			static_cast<long long>(entry.expires), static_cast<U32>(entry.body.size()));
+		fwrite(entry.body.data(), 1, entry.body.size(), file);
+		bool error = (ferror(file) != 0);
+		if (fclose(file) != 0 || error) {
+			remove(tempPath.c_str());
+			return;
+		}
+
+		auto existing = gIndex.find(key);
+		if (existing != gIndex.end()) {
+			removeEntry(existing);
+		}
+		if (!replaceFile(tempPath, path)) {
+			remove(tempPath.c_str());
+			return;
+		}
+
+		struct stat st;
+		U64 size = (stat(path.c_str(), &st) == 0 ? static_cast<U64>(st.st_size) : entry.body.size());
+		gLru.push_front(IndexEntry{key, size});
+		gIndex[key] = gLru.begin();
+		gTotalSize += size;
+		gStores++;
+
+		evict();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(httpCacheEnable, void, 3, 3, "httpCacheEnable(directory, maxBytes) - Cache HTTPObject GET responses on disk") {
+	char expanded[0x100];
+	TGE::Con::expandScriptFilename(expanded, 0x100, argv[1]);
+	//Checked as a directory, so the cache can't be put outside the game folder
+	if (!isValidDownloadPath(std::string(expanded) + "/")) {
+		TGE::Con::errorf("httpCacheEnable: Cannot use %s as the cache directory", expanded);
+		return;
+	}
+
+	HttpCache::gDirectory = expanded;
+	HttpCache::gMaxSize = strtoull(argv[2], NULL, 10);
+	createParentDirectories(HttpCache::gDirectory + "/");
+	HttpCache::scanDirectory();
+	HttpCache::gEnabled = true;
+	HttpCache::evict();
+}
+
+MBX_CONSOLE_FUNCTION(httpCacheDisable, void, 1, 1, "httpCacheDisable() - Stop caching HTTPObject responses. Cached files are kept.") {
+	HttpCache::gEnabled = false;
+}
+
+MBX_CONSOLE_FUNCTION(httpCacheClear, void, 1, 1, "httpCacheClear() - Delete all cached responses") {
+	while (!HttpCache::gIndex.empty()) {
+		HttpCache::removeEntry(HttpCache::gIndex.begin());
+	}
+}
+
+MBX_CONSOLE_FUNCTION(httpCacheGetStats, const char *, 1, 1, "httpCacheGetStats() - Get \"hits misses revalidations stores evictions entries bytes\"") {
+	char *ret = TGE::Con::getReturnBuffer(128);
+	snprintf(ret, 128, "%u %u %u %u %u %u %llu", HttpCache::gHits, HttpCache::gMisses, HttpCache::gRevalidations,
+		HttpCache::gStores, HttpCache::gEvictions, static_cast<U32>(HttpCache::gIndex.size()),
+		static_cast<unsigned long long>(HttpCache::gTotalSize));
+	return ret;
+}
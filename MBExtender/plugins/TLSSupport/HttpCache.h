@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// HttpCache.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <MBExtender/MBExtender.h>
+#include <time.h>
+#include <string>
+
+/**
+ * On-disk cache for HTTPObject responses, keyed by URL. Entries remember the
+ * ETag and Last-Modified validators so stale entries can be revalidated with
+ * a conditional request instead of downloaded again. The cache is limited in
+ * size and evicts the least recently used entries first.
+ */
+namespace HttpCache {
+	struct Entry {
+		std::string etag;
+		std::string lastModified;
+		//Kept so the charset is known when the body is reused
+		std::string contentType;
+		//Unix time after which the entry has to be revalidated
+		time_t expires = 0;
+		std::string body;
+	};
+
+	bool isEnabled();
+
+	/**
+	 * Work out how long a response can be used without revalidating.
+	 * @arg cacheControl The Cache-Control header, or NULL.
+	 * @arg expiresHeader The Expires header, or NULL.
+	 * @arg now The current time.
+	 * @arg expires Set to the time the response goes stale.
+	 * @return False if the response must not be stored (no-store).
+	 */
+	bool getExpiry(const char *cacheControl, const char *expiresHeader, time_t now, time_t &expires);
+
+	/**
+	 * Look up a cached response.
+	 * @arg url The full request URL.
+	 * @arg entry Filled in with the cached response.
+	 * @return True if there is a cached response for the URL.
+	 */
+	bool load(const std::string &url, Entry &entry);
+
+	/**
+	 * Add or replace a cached response, evicting old entries if the cache is
+	 * over its size limit.
+	 */
+	void store(const std::string &url, const Entry &entry);
+
+	//Statistics
+	void countHit();
+	void countMiss();
+	void countRevalidation();
+}
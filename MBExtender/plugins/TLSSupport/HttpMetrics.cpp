@@ -0,0 +1,172 @@
+//-----------------------------------------------------------------------------
+// HttpMetrics.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "HttpMetrics.h"
+#include "TLSSupport.h"
+#include <MathLib/MathLib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+
+#include <TorqueLib/console/console.h>
+
+MBX_MODULE(HttpMetrics);
+
+namespace HttpMetrics {
+	//Upper bounds of the histogram buckets for total time, in milliseconds.
+	// There is one more bucket for everything slower.
+	static const F64 gBuckets[] = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000};
+	static const U32 gBucketCount = sizeof(gBuckets) / sizeof(gBuckets[0]) + 1;
+
+	struct PhaseStats {
+		F64 sum = 0;
+		F64 min = 0;
+		F64 max = 0;
+
+		void add(F64 value, bool first) {
+			sum += value;
+			min = (first ? value : std::min(min, value));
+			max = (first ? value : std::max(max, value));
+		}
+	};
+
+	struct HostStats {
+		U32 requests = 0;
+		U32 failures = 0;
+		PhaseStats dns;
+		PhaseStats connect;
+		PhaseStats tls;
+		PhaseStats firstByte;
+		PhaseStats total;
+		U32 histogram[gBucketCount] = {};
+	};
+
+	//Sorted so dumps come out in a stable order
+	static std::map<std::string, HostStats> gHosts;
+
+	Timings getTimings(CURL *easy) {
+		//curl's times are all in seconds, from the start of the request
+		double nameLookup = 0, connect = 0, appConnect = 0, startTransfer = 0, total = 0;
+		curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME, &nameLookup);
+		curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME, &connect);
+		curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME, &appConnect);
+		curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &startTransfer);
+		curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &total);
+
+		Timings timings;
+		timings.dns = nameLookup * 1000.0;
+		timings.connect = std::max(0.0, connect - nameLookup) * 1000.0;
+		//Zero if there was no TLS handshake
+		timings.tls = (appConnect > 0 ? std::max(0.0, appConnect - connect) * 1000.0 : 0);
+		timings.firstByte = startTransfer * 1000.0;
+		timings.total = total * 1000.0;
+		return timings;
+	}
+
+	void record(const std::string &url, const Timings &timings, bool success) {
+		HostStats &stats = gHosts[getUrlHost(url)];
+		bool first = (stats.requests == 0);
+		stats.requests++;
+		if (!success)
+			stats.failures++;
+
+		stats.dns.add(timings.dns, first);
+		stats.connect.add(timings.connect, first);
+		stats.tls.add(timings.tls, first);
+		stats.firstByte.add(timings.firstByte, first);
+		stats.total.add(timings.total, first);
+
+		U32 bucket = 0;
+		while (bucket < gBucketCount - 1 && timings.total > gBuckets[bucket])
+			bucket++;
+		stats.histogram[bucket]++;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Console functions
+//------------------------------------------------------------------------------
+
+MBX_CONSOLE_FUNCTION(httpDumpMetrics, void, 1, 1, "httpDumpMetrics() - Print request timings for each host") {
+	for (auto it = HttpMetrics::gHosts.begin(); it != HttpMetrics::gHosts.end(); ++it) {
+		const HttpMetrics::HostStats &stats = it->second;
+		F64 count = static_cast<F64>(stats.requests);
+		TGE::Con::printf("%s: %u requests, %u failed", it->first.c_str(), stats.requests, stats.failures);
+		TGE::Con::printf("   avg ms: dns %.1f, connect %.1f, tls %.1f, first byte %.1f, total %.1f",
+			stats.dns.sum / count, stats.connect.sum / count, stats.tls.sum / count,
+			stats.firstByte.sum / count, stats.total.sum / count);
+		TGE::Con::printf("   total ms: min %.1f, max %.1f", stats.total.min, stats.total.max);
+
+		std::string histogram;
+		for (U32 i = 0; i < HttpMetrics::gBucketCount; i++) {
+			char bucket[32];
+			if (i < HttpMetrics::gBucketCount - 1)
+				snprintf(bucket, sizeof(bucket), " <=%.0f:%u", HttpMetrics::gBuckets[i], stats.histogram[i]);
+			else
+				snprintf(bucket, sizeof(bucket), " >%.0f:%u", HttpMetrics::gBuckets[i - 1], stats.histogram[i]);
+			histogram += bucket;
+		}
+		TGE::Con::printf("   histogram:%s", histogram.c_str());
+	}
+}
+
+MBX_CONSOLE_FUNCTION(httpWriteMetricsCSV, bool, 2, 2, "httpWriteMetricsCSV(path) - Write request timings for each host as CSV") {
+	char expanded[0x100];
+	TGE::Con::expandScriptFilename(expanded, 0x100, argv[1]);
+	if (!isValidDownloadPath(expanded)) {
+		TGE::Con::errorf("httpWriteMetricsCSV: Cannot write to %s", expanded);
+		return false;
+	}
+	createParentDirectories(expanded);
+
+	FILE *file = fopen(expanded, "w");
+	if (file == NULL) {
+		TGE::Con::errorf("httpWriteMetricsCSV: Could not open %s", expanded);
+		return false;
+	}
+
+	fprintf(file, "host,requests,failures,dns_avg_ms,connect_avg_ms,tls_avg_ms,first_byte_avg_ms,total_avg_ms,total_min_ms,total_max_ms");
+	for (U32 i = 0; i < HttpMetrics::gBucketCount - 1; i++) {
+		fprintf(file, ",le_%.0fms", HttpMetrics::gBuckets[i]);
+	}
+	fprintf(file, ",gt_%.0fms\n", HttpMetrics::gBuckets[HttpMetrics::gBucketCount - 2]);
+
+	for (auto it = HttpMetrics::gHosts.begin(); it != HttpMetrics::gHosts.end(); ++it) {
+		const HttpMetrics::HostStats &stats = it->second;
+		F64 count = static_cast<F64>(stats.requests);
+		fprintf(file, "%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f", it->first.c_str(), stats.requests, stats.failures,
+			stats.dns.sum / count, stats.connect.sum / count, stats.tls.sum / count,
+			stats.firstByte.sum / count, stats.total.sum / count, stats.total.min, stats.total.max);
+		for (U32 i = 0; i < HttpMetrics::gBucketCount; i++) {
+			fprintf(file, ",%u", stats.histogram[i]);
+		}
+		fprintf(file, "\n");
+	}
+
+	return fclose(file) == 0;
+}
+
+MBX_CONSOLE_FUNCTION(httpResetMetrics, void, 1, 1, "httpResetMetrics() - Clear all request timings") {
+	HttpMetrics::gHosts.clear();
+}
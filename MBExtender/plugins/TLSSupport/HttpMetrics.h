@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// HttpMetrics.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <MBExtender/MBExtender.h>
+#include <TorqueLib/platform/platform.h>
+#include <curl/curl.h>
+#include <string>
+
+/**
+ * Timing statistics for HTTPObject requests, collected from curl after each
+ * transfer and aggregated per host.
+ */
+namespace HttpMetrics {
+	//All in milliseconds. dns, connect and tls are how long each step took
+	// (0 if a connection was reused), firstByte and total are measured from
+	// the start of the request.
+	struct Timings {
+		F64 dns = 0;
+		F64 connect = 0;
+		F64 tls = 0;
+		F64 firstByte = 0;
+		F64 total = 0;
+	};
+
+	/**
+	 * Read the timings of a finished transfer.
+	 */
+	Timings getTimings(CURL *easy);
+
+	/**
+	 * Add a finished request to the statistics for its host.
+	 * @arg url The URL of the request.
+	 * @arg timings The request's timings.
+	 * @arg success If the transfer succeeded.
+	 */
+	void record(const std::string &url, const Timings &timings, bool success);
+}
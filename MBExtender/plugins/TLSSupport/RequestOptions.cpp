@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------
+// RequestOptions.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "RequestOptions.h"
+
+namespace RequestOptions {
+	CURLM *createMulti(bool http2) {
+		CURLM *multi = curl_multi_init();
+		if (multi == nullptr)
+			return nullptr;
+		//Requests to the same server queue up for a connection instead of all
+		// opening their own
+		curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, 6L);
+		if (http2) {
+			curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+		}
+		return multi;
+	}
+
+	CURLSH *createShare() {
+		CURLSH *share = curl_share_init();
+		if (share == nullptr)
+			return nullptr;
+		//Everything runs on the main thread, so no lock functions are needed
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+		return share;
+	}
+
+	void applyDefaults(CURL *easy, CURLSH *share, bool http2) {
+		curl_easy_setopt(easy, CURLOPT_SHARE, share);
+		curl_easy_setopt(easy, CURLOPT_VERBOSE, 0L);
+		curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(easy, CURLOPT_TRANSFERTEXT, 1L);
+		curl_easy_setopt(easy, CURLOPT_USERAGENT, "Torque 1.0");
+		if (http2) {
+			//HTTP/2 for https if the server offers it, HTTP/1.1 otherwise. Waiting
+			// for an existing connection lets requests made together find out if
+			// they can share it instead of all connecting at once.
+			curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+			curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+		}
+		//Empty means every encoding curl supports (gzip and deflate). This is only
+		// the transfer encoding, charsets are handled in processLines.
+		curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+	}
+
+	void setResumeFrom(CURL *easy, uint64_t resumeFrom) {
+		curl_easy_setopt(easy, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(resumeFrom));
+	}
+
+	void setMaxSize(CURL *easy, uint64_t maxSize, uint64_t resumeFrom) {
+		if (maxSize == 0)
+			return;
+		//Lets curl reject responses with a Content-Length that is too big
+		// before downloading anything
+		uint64_t remaining = (maxSize > resumeFrom ? maxSize - resumeFrom : 1);
+		curl_easy_setopt(easy, CURLOPT_MAXFILESIZE_LARGE, static_cast<curl_off_t>(remaining));
+	}
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// RequestOptions.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <curl/curl.h>
+#include <stdint.h>
+
+/**
+ * The curl options every HTTPObject request is made with. These don't touch
+ * the engine, so the HTTP test harness (src/HttpTest) sets up its requests
+ * with the same code.
+ */
+namespace RequestOptions {
+	/**
+	 * Create the multi handle all requests run on.
+	 * @arg http2 If curl supports HTTP/2, so requests can be multiplexed.
+	 */
+	CURLM *createMulti(bool http2);
+
+	/**
+	 * Create the share handle for DNS lookups and TLS sessions.
+	 */
+	CURLSH *createShare();
+
+	/**
+	 * Set the options a new request starts with.
+	 * @arg easy The request's handle.
+	 * @arg share The handle from createShare().
+	 * @arg http2 If curl supports HTTP/2.
+	 */
+	void applyDefaults(CURL *easy, CURLSH *share, bool http2);
+
+	/**
+	 * Ask for a download to continue from where an earlier attempt stopped.
+	 * @arg easy The request's handle.
+	 * @arg resumeFrom Bytes already downloaded, 0 to start from the beginning.
+	 */
+	void setResumeFrom(CURL *easy, uint64_t resumeFrom);
+
+	/**
+	 * Limit the size of the response body.
+	 * @arg easy The request's handle.
+	 * @arg maxSize Most bytes the whole body may have, 0 for no limit.
+	 * @arg resumeFrom Bytes already downloaded, which count towards the limit.
+	 */
+	void setMaxSize(CURL *easy, uint64_t maxSize, uint64_t resumeFrom);
+}
@@ -25,11 +25,23 @@
 #include <MBExtender/MBExtender.h>
 #include <MathLib/MathLib.h>
 #include <curl/curl.h>
+#include <zlib.h>
+#include <algorithm>
+#include <deque>
 #include <unordered_map>
+#include <vector>
 #include <sstream>
 #include <mutex>
 #include <atomic>
 #include <fstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "HttpCache.h"
+#include "HttpMetrics.h"
+#include "RequestOptions.h"
+#include "TLSSupport.h"
 
 #include <TorqueLib/game/net/httpObject.h>
 #include <TorqueLib/core/resManager.h>
@@ -37,6 +49,8 @@
 #include <TorqueLib/core/fileStream.h>
 
 #ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
 #define strcasecmp _stricmp
 #else
 #include <strings.h>
@@ -44,6 +58,46 @@
 
 MBX_MODULE(TLSSupport);
 
+bool isValidDownloadPath(const std::string &path) {
+	if (path.empty() || path[0] == '/' || path.find(':') != std::string::npos)
+		return false;
+	if (path.find("../") != std::string::npos)
+		return false;
+	return path.find_last_of('/') != std::string::npos;
+}
+
+void createParentDirectories(const std::string &path) {
+	for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+		std::string directory = path.substr(0, slash);
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+}
+
+std::string getUrlHost(const std::string &url) {
+	size_t start = url.find("://");
+	start = (start == std::string::npos ? 0 : start + 3);
+	size_t end = url.find_first_of("/?#", start);
+	std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+	//Don't keep credentials around
+	size_t at = authority.find_last_of('@');
+	if (at != std::string::npos)
+		authority.erase(0, at + 1);
+	return authority;
+}
+
+bool replaceFile(const std::string &from, const std::string &to) {
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
 namespace {
 
 struct curlInfo {
@@ -56,34 +110,222 @@ struct curlInfo {
 
 	std::string url;
 	std::string values;
+	//Used for the per-host transfer limit
+	std::string mHost;
 
 	bool download = false;
 	std::string downloadPath;
 
+	//Downloads are written to downloadPath + ".part" as they arrive and
+	// renamed once they finish
+	FILE *mDownloadFile = nullptr;
+	bool mDownloadStarted = false;
+	bool mResume = false;
+	U64 mResumeFrom = 0;
+
+	//Limit on the size of the response body, 0 for no limit
+	U64 mMaxSize = 0;
+	U64 mReceived = 0;
+	bool mTooLarge = false;
+
+	//Incremental requests send lines to script while the transfer is still
+	// running. Lines are sent at most mLinesPerFrame at a time, 0 for no limit.
+	bool mIncremental = false;
+	U32 mLinesPerFrame = 0;
+	//Start of the data in mBuffer that hasn't been sent as lines yet
+	U32 mLineStart = 0;
+
+	//Set once the transfer is done, while the rest of the lines are sent
+	bool mDone = false;
+	bool mStatus = false;
+
+	//How often onProgress is called, 0 to never call it
+	U32 mProgressInterval = 0;
+	U32 mLastProgressTime = 0;
+	U64 mLastProgressBytes = 0;
+
+	//GET responses can be served from and stored in HttpCache
+	bool mCache = true;
+	bool mCacheable = false;
+	//Set if a stale cached response is being revalidated
+	bool mHasCached = false;
+	HttpCache::Entry mCached;
+
+	//Charset to convert lines from, overriding the response's Content-Type.
+	// Empty to use the Content-Type.
+	std::string mCharset;
+	//Gzip the POST body
+	bool mCompressBody = false;
+
+	//Filled in when the transfer finishes
+	HttpMetrics::Timings mTimings;
+
 	curl_slist *headers = nullptr;
 	std::unordered_map<std::string, std::string> mRecieveHeaders;
 
+	const char *getHeader(const char *name) const;
+	bool isLatin1() const;
+
 	bool ensureBuffer(U32 length);
 	size_t processData(char *buffer, size_t size, size_t nitems);
+	size_t processDownload(char *buffer, size_t length);
 	size_t processHeader(char *buffer, size_t size, size_t nitems);
 
 	void start();
-	void processLines();
+	void activate();
+	bool processLines(bool final);
+	void processProgress(U32 time);
+	void finishDownload(bool status, int responseCode);
+	void setBody(const std::string &body);
+	void releaseHandles();
+	void serveCached();
+	void finishCache(int responseCode);
 	void finish(CURLcode errorCode);
+	bool process(U32 time);
 };
 
 CURLM *gCurlMulti;
 int gCurlMultiTotal = 0;
+
+//If libcurl was built with HTTP/2 support. When it is, requests to the same
+// server are multiplexed over one connection.
+bool gHttp2 = false;
+
+//Limit on transfers running at once to one host, 0 for no limit. With HTTP/2
+// these are streams on one connection, which CURLMOPT_MAX_HOST_CONNECTIONS
+// doesn't limit. Requests over the limit wait in gWaitingRequests.
+U32 gMaxTransfersPerHost = 16;
+std::unordered_map<std::string, U32> gActiveTransfers;
+std::deque<curlInfo *> gWaitingRequests;
+//Requests whose transfer is done but still have lines to send
+std::vector<curlInfo *> gFinishingRequests;
+
+//DNS lookups and TLS sessions are shared between all requests. Connections
+// themselves are already kept alive in gCurlMulti's connection cache.
+CURLSH *gCurlShare;
+
+//Finished easy handles are reset and reused instead of being recreated
+std::vector<CURL *> gEasyPool;
+const size_t gMaxPooledHandles = 8;
+
+//Totals for httpGetConnectionStats()
+U32 gRequestCount = 0;
+U32 gNewConnectionCount = 0;
+U32 gHttp2Count = 0;
 std::unordered_map<CURL *, curlInfo *> gCurlMap;
 std::unordered_map<TGE::HTTPObject *, curlInfo *> gInverseMap;
 
+/**
+ * Gzip a request body.
+ * @arg data The data to compress.
+ * @arg compressed Set to the gzip stream.
+ * @return If the data could be compressed.
+ */
+bool gzipCompress(const std::string &data, std::string &compressed) {
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	//15 window bits, +16 for a gzip header instead of a zlib one
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	compressed.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	stream.avail_in = static_cast<uInt>(data.size());
+	stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+	stream.avail_out = static_cast<uInt>(compressed.size());
+
+	int result = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	return result == Z_STREAM_END;
+}
+
+/**
+ * Get the charset parameter out of a Content-Type header, lowercased.
+ */
+std::string getCharset(const char *contentType) {
+	if (contentType == NULL)
+		return "";
+	std::string type(contentType);
+	std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+
+	size_t start = type.find("charset=");
+	if (start == std::string::npos)
+		return "";
+	start += 8;
+	if (start < type.size() && type[start] == '"')
+		start++;
+	size_t end = type.find_first_of("\"; ", start);
+	return type.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+CURL *acquireEasyHandle() {
+	if (gEasyPool.empty()) {
+		return curl_easy_init();
+	}
+	CURL *easy = gEasyPool.back();
+	gEasyPool.pop_back();
+	return easy;
+}
+
+void releaseEasyHandle(CURL *easy) {
+	if (gEasyPool.size() >= gMaxPooledHandles) {
+		curl_easy_cleanup(easy);
+		return;
+	}
+	//Clears all options but keeps the handle's caches
+	curl_easy_reset(easy);
+	gEasyPool.push_back(easy);
+}
+
 void curlInfo::start() {
+	if (download) {
+		//Pick up where a previous attempt left off
+		mResumeFrom = 0;
+		if (mResume) {
+			struct stat st;
+			if (stat((downloadPath + ".part").c_str(), &st) == 0 && st.st_size > 0) {
+				mResumeFrom = static_cast<U64>(st.st_size);
+			}
+		}
+		RequestOptions::setResumeFrom(easy, mResumeFrom);
+	}
+	if (headers != nullptr) {
+		curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers);
+	}
+	RequestOptions::setMaxSize(easy, mMaxSize, mResumeFrom);
+
+	mHost = getUrlHost(url);
+	if (gMaxTransfersPerHost != 0 && gActiveTransfers[mHost] >= gMaxTransfersPerHost) {
+		gWaitingRequests.push_back(this);
+		return;
+	}
+	activate();
+}
+
+void curlInfo::activate() {
 	CURLMcode result = curl_multi_add_handle(gCurlMulti, easy);
 	if (result != CURLM_OK) {
 		TGE::Con::errorf("curl_easy_perform failed (%d): %s", result, curl_multi_strerror(result));
 		return;
 	}
 	++gCurlMultiTotal;
+	++gActiveTransfers[mHost];
+}
+
+/**
+ * Start any waiting requests whose host is under the transfer limit again.
+ */
+void startWaitingRequests() {
+	for (auto it = gWaitingRequests.begin(); it != gWaitingRequests.end(); ) {
+		curlInfo *info = *it;
+		if (gMaxTransfersPerHost == 0 || gActiveTransfers[info->mHost] < gMaxTransfersPerHost) {
+			it = gWaitingRequests.erase(it);
+			info->activate();
+		} else {
+			++it;
+		}
+	}
 }
 
 bool curlInfo::ensureBuffer(U32 length) {
@@ -105,6 +347,17 @@ bool curlInfo::ensureBuffer(U32 length) {
 }
 
 size_t curlInfo::processData(char *buffer, size_t size, size_t nitems) {
+	//Servers that don't send a Content-Length still need to be cut off
+	mReceived += size * nitems;
+	if (mMaxSize != 0 && mResumeFrom + mReceived > mMaxSize) {
+		mTooLarge = true;
+		return 0;
+	}
+
+	if (download) {
+		return processDownload(buffer, size * nitems);
+	}
+
 	size_t writeSize = size * nitems + 1;
 
 	if (!ensureBuffer(mBufferUsed + writeSize)) {
@@ -119,6 +372,42 @@ size_t curlInfo::processData(char *buffer, size_t size, size_t nitems) {
 	return size * nitems;
 }
 
+size_t curlInfo::processDownload(char *buffer, size_t length) {
+	if (!mDownloadStarted) {
+		mDownloadStarted = true;
+
+		int responseCode;
+		curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &responseCode);
+
+		std::string partPath = downloadPath + ".part";
+		if (responseCode == 206 && mResumeFrom > 0) {
+			mDownloadFile = fopen(partPath.c_str(), "ab");
+		} else if (responseCode == 200) {
+			//Either a fresh download or the server ignored the Range header
+			mResumeFrom = 0;
+			createParentDirectories(downloadPath);
+			mDownloadFile = fopen(partPath.c_str(), "wb");
+		} else {
+			//Don't download unless we get an OK, the error body is dropped
+			return length;
+		}
+
+		if (mDownloadFile == nullptr) {
+			TGE::Con::errorf("Could not download %s: error opening %s.", downloadPath.c_str(), partPath.c_str());
+			return 0;
+		}
+	}
+
+	if (mDownloadFile == nullptr) {
+		return length;
+	}
+	if (fwrite(buffer, 1, length, mDownloadFile) != length) {
+		TGE::Con::errorf("Could not download %s: error writing file.", downloadPath.c_str());
+		return 0;
+	}
+	return length;
+}
+
 size_t curlInfo::processHeader(char *buffer, size_t size, size_t nitems) {
 	char *colon = strchr(buffer, ':');
 	if (colon != NULL) {
@@ -136,83 +425,273 @@ size_t curlInfo::processHeader(char *buffer, size_t size, size_t nitems) {
 	return size * nitems;
 }
 
-void curlInfo::processLines() {
-	if (download) {
-		const std::string &dlPath = downloadPath;
-		int lastSlash = dlPath.find_last_of('/');
+/**
+ * Find a response header, ignoring case.
+ * @return The header's value, or NULL if it wasn't sent.
+ */
+const char *curlInfo::getHeader(const char *name) const {
+	for (auto it = mRecieveHeaders.begin(); it != mRecieveHeaders.end(); ++it) {
+		if (strcasecmp(it->first.c_str(), name) == 0)
+			return it->second.c_str();
+	}
+	return NULL;
+}
+
+/**
+ * Check if lines need converting from ISO 8859-1 to UTF-8, which is what
+ * strings in the engine are.
+ */
+bool curlInfo::isLatin1() const {
+	std::string charset = (mCharset.empty() ? getCharset(getHeader("Content-Type")) : mCharset);
+	return charset == "iso-8859-1" || charset == "iso8859-1" || charset == "latin1";
+}
 
-		const char *path;
-		const char *file;
+/**
+ * Replace the buffered response with a cached one.
+ */
+void curlInfo::setBody(const std::string &body) {
+	mBufferUsed = 0;
+	mLineStart = 0;
+	if (body.empty() || !ensureBuffer(static_cast<U32>(body.size()) + 1)) {
+		return;
+	}
+	memcpy(mBuffer, body.data(), body.size());
+	mBufferUsed = static_cast<U32>(body.size());
+	mBuffer[mBufferUsed] = 0;
+}
 
-		if (lastSlash == std::string::npos) {
-			//No
-			return;
-		} else {
-			path = TGE::StringTable->insert(dlPath.c_str(), false);
-			file = TGE::StringTable->insert(dlPath.substr(lastSlash + 1).c_str(), false);
-		}
+/**
+ * Put the easy handle back in the pool and free the request headers, once
+ * the request no longer needs them.
+ */
+void curlInfo::releaseHandles() {
+	releaseEasyHandle(easy);
+	easy = nullptr;
+	if (headers != nullptr) {
+		curl_slist_free_all(headers);
+		headers = nullptr;
+	}
+}
 
-		//Don't download unless we get an OK
-		int responseCode;
-		curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &responseCode);
-		if (responseCode != 200) {
-			TGE::Con::executef(obj, 2, "downloadFailed", path);
-			return;
-		}
+/**
+ * Finish the request with a fresh cached response, without any network
+ * traffic. Lines are still sent from clientProcess like any other request.
+ */
+void curlInfo::serveCached() {
+	HttpCache::countHit();
+
+	setBody(mCached.body);
+	mCached.body.clear();
+	if (!mCached.contentType.empty()) {
+		mRecieveHeaders["Content-Type"] = mCached.contentType;
+	}
+	mDone = true;
+	mStatus = true;
 
-		//Write to the output file
-		TGE::FileStream *stream = TGE::FileStream::create();
+	gCurlMap.erase(easy);
+	releaseHandles();
+	gFinishingRequests.push_back(this);
+}
 
-		if (!TGE::ResourceManager->openFileForWrite(*stream, path, 0x1)) {
-			TGE::Con::errorf("Could not download %s: error opening stream.");
-			TGE::Con::executef(obj, 2, "downloadFailed", path);
-			return;
+/**
+ * Update the cache with the response to a cacheable request.
+ */
+void curlInfo::finishCache(int responseCode) {
+	time_t now = time(NULL);
+	time_t expires;
+	bool storable = HttpCache::getExpiry(getHeader("Cache-Control"), getHeader("Expires"), now, expires);
+
+	if (responseCode == 304 && mHasCached) {
+		//Not modified, so the body we have is still good
+		HttpCache::countRevalidation();
+		if (storable) {
+			mCached.expires = expires;
+			HttpCache::store(url, mCached);
+		}
+		setBody(mCached.body);
+		if (getHeader("Content-Type") == NULL && !mCached.contentType.empty()) {
+			mRecieveHeaders["Content-Type"] = mCached.contentType;
 		}
+		return;
+	}
 
-		stream->_write(mBufferUsed, mBuffer);
-		stream->close();
+	HttpCache::countMiss();
+	if (responseCode != 200 || !storable)
+		return;
 
-		TGE::Con::executef(obj, 2, "onDownload", path);
+	HttpCache::Entry entry;
+	const char *etag = getHeader("ETag");
+	const char *lastModified = getHeader("Last-Modified");
+	const char *contentType = getHeader("Content-Type");
+	entry.etag = (etag ? etag : "");
+	entry.lastModified = (lastModified ? lastModified : "");
+	entry.contentType = (contentType ? contentType : "");
+	entry.expires = expires;
+
+	//No point storing something that can neither be reused nor revalidated
+	if (expires <= now && entry.etag.empty() && entry.lastModified.empty())
+		return;
 
-		//I can't figure out how to delete this without crashing. So this.
-		delete stream;
-	} else {
+	entry.body.assign(reinterpret_cast<const char *>(mBuffer), mBufferUsed);
+	HttpCache::store(url, entry);
+}
 
-		//Pull all the lines out of mBuffer
-		char *str = (char *)mBuffer;
-		char *nextLine = str;
-		while (str && nextLine) {
-			nextLine = strchr(str, '\n');
-
-			//Get how long the current line for allocating
-			U32 lineSize = 0;
-			if (nextLine == NULL) {
-				lineSize = strlen(str);
-				if (lineSize == 0) {
-					break;
-				}
-			} else {
-				lineSize = nextLine - str;
+/**
+ * Send buffered lines to script as onLine callbacks.
+ * @arg final If the transfer is done. The last line is only sent once the
+ *            transfer is done, since it might not be complete before then.
+ * @return True if there are no more lines to send.
+ */
+bool curlInfo::processLines(bool final) {
+	//Lines are split on \n only, which never appears inside a multi-byte UTF-8
+	// sequence. So a sequence (or a CRLF) that's cut off between two reads
+	// just stays in the buffer with the rest of its line until the line is
+	// complete.
+	bool latin1 = isLatin1();
+	U32 sent = 0;
+	while (mLineStart < mBufferUsed) {
+		if (mLinesPerFrame != 0 && sent >= mLinesPerFrame) {
+			break;
+		}
+
+		char *str = (char *)mBuffer + mLineStart;
+		char *nextLine = (char *)memchr(str, '\n', mBufferUsed - mLineStart);
+
+		//Get how long the current line for allocating
+		U32 lineSize = 0;
+		if (nextLine == NULL) {
+			if (!final) {
+				break;
 			}
+			lineSize = strlen(str);
+			if (lineSize == 0) {
+				mLineStart = mBufferUsed;
+				break;
+			}
+		} else {
+			lineSize = nextLine - str;
+		}
 
-			//Copy into a return buffer for the script
-			char *line = TGE::Con::getReturnBuffer(lineSize + 1);
+		//Copy into a return buffer for the script
+		char *line;
+		U32 lineLength = lineSize;
+		if (latin1) {
+			//Every byte above 0x7F turns into two
+			U32 extra = 0;
+			for (U32 i = 0; i < lineSize; i++) {
+				if (static_cast<U8>(str[i]) >= 0x80)
+					extra++;
+			}
+			line = TGE::Con::getReturnBuffer(lineSize + extra + 1);
+			U32 pos = 0;
+			for (U32 i = 0; i < lineSize; i++) {
+				U8 ch = static_cast<U8>(str[i]);
+				if (ch >= 0x80) {
+					line[pos++] = static_cast<char>(0xC0 | (ch >> 6));
+					line[pos++] = static_cast<char>(0x80 | (ch & 0x3F));
+				} else {
+					line[pos++] = static_cast<char>(ch);
+				}
+			}
+			lineLength = pos;
+		} else {
+			line = TGE::Con::getReturnBuffer(lineSize + 1);
 			memcpy(line, str, lineSize);
-			line[lineSize] = 0;
+		}
+		line[lineLength] = 0;
 
-			//Strip the \r from \r\n
-			if (lineSize > 0 && line[lineSize - 1] == '\r') {
-				line[lineSize - 1] = 0;
-			}
+		//Strip the \r from \r\n
+		if (lineLength > 0 && line[lineLength - 1] == '\r') {
+			line[lineLength - 1] = 0;
+		}
 
-			TGE::Con::executef(obj, 2, "onLine", line);
+		//Strip the \n
+		mLineStart += lineSize + (nextLine ? 1 : 0);
+		sent++;
 
-			if (nextLine) {
-				//Strip the \n
-				str = nextLine + 1;
-			}
+		TGE::Con::executef(obj, 2, "onLine", line);
+	}
+
+	//Drop the lines that were sent so the buffer doesn't keep growing
+	if (mLineStart > 0 && mBuffer) {
+		memmove(mBuffer, mBuffer + mLineStart, mBufferUsed - mLineStart + 1);
+		mBufferUsed -= mLineStart;
+		mLineStart = 0;
+	}
+
+	return mBufferUsed == 0;
+}
+
+void curlInfo::processProgress(U32 time) {
+	if (mProgressInterval == 0 || time - mLastProgressTime < mProgressInterval)
+		return;
+	U64 received = mResumeFrom + mReceived;
+	if (received == mLastProgressBytes)
+		return;
+	mLastProgressTime = time;
+	mLastProgressBytes = received;
+
+	//-1 if the server didn't say
+	double length;
+	curl_easy_getinfo(easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length);
+	U64 total = (length < 0 ? 0 : mResumeFrom + static_cast<U64>(length));
+
+	char receivedStr[32];
+	char totalStr[32];
+	snprintf(receivedStr, sizeof(receivedStr), "%llu", static_cast<unsigned long long>(received));
+	snprintf(totalStr, sizeof(totalStr), "%llu", static_cast<unsigned long long>(total));
+	TGE::Con::executef(obj, 3, "onProgress", receivedStr, totalStr);
+}
+
+void curlInfo::finishDownload(bool status, int responseCode) {
+	std::string partPath = downloadPath + ".part";
+	if (status && !mDownloadStarted && responseCode == 200) {
+		//Empty body, so processDownload never ran. Still make the (empty) file.
+		mDownloadStarted = true;
+		mResumeFrom = 0;
+		createParentDirectories(downloadPath);
+		mDownloadFile = fopen(partPath.c_str(), "wb");
+		if (mDownloadFile == nullptr) {
+			TGE::Con::errorf("Could not download %s: error opening %s.", downloadPath.c_str(), partPath.c_str());
 		}
 	}
+	bool written = (mDownloadFile != nullptr);
+	if (mDownloadFile != nullptr) {
+		if (fclose(mDownloadFile) != 0)
+			status = false;
+		mDownloadFile = nullptr;
+	}
+
+	const char *path = TGE::StringTable->insert(downloadPath.c_str(), false);
+
+	if (!status || !written) {
+		//Keep partial data around if it can be resumed later
+		if (!written || !mResume || mTooLarge) {
+			remove(partPath.c_str());
+		}
+		TGE::Con::executef(obj, 2, "downloadFailed", path);
+		return;
+	}
+
+	//Swap the finished file in, so nothing ever sees a partial download
+	if (!replaceFile(partPath, downloadPath)) {
+		TGE::Con::errorf("Could not download %s: error renaming %s.", downloadPath.c_str(), partPath.c_str());
+		remove(partPath.c_str());
+		TGE::Con::executef(obj, 2, "downloadFailed", path);
+		return;
+	}
+
+	//Let the resource manager know about the file, same as openFileForWrite
+	size_t lastSlash = downloadPath.find_last_of('/');
+	TGE::ResourceObject *ro = TGE::ResourceManager->createResource(
+		TGE::StringTable->insert(downloadPath.substr(0, lastSlash).c_str(), false),
+		TGE::StringTable->insert(downloadPath.substr(lastSlash + 1).c_str(), false));
+	ro->flags = TGE::ResourceObject::File;
+	ro->fileOffset = 0;
+	ro->fileSize = 0;
+	ro->compressedFileSize = 0;
+
+	TGE::Con::executef(obj, 2, "onDownload", path);
 }
 
 void curlInfo::finish(CURLcode errorCode) {
@@ -224,25 +703,75 @@ void curlInfo::finish(CURLcode errorCode) {
 	curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &responseCode);
 	TGE::Con::printf("HTTP Response code: %d", responseCode);
 
-	if (status) {
-		//We're done
-		processLines();
-	} else {
+	if (mTooLarge || errorCode == CURLE_FILESIZE_EXCEEDED) {
+		TGE::Con::errorf("Response is larger than the limit of %llu bytes", static_cast<unsigned long long>(mMaxSize));
+	}
+
+	if (!status) {
 		TGE::Con::errorf("Error info: Code %d: %s", errorCode, curl_easy_strerror(errorCode));
 	}
+	if (download) {
+		finishDownload(status, responseCode);
+	} else if (!status) {
+		//Lines from a failed transfer aren't sent
+		mBufferUsed = 0;
+	} else if (mCacheable) {
+		finishCache(responseCode);
+	}
+	mDone = true;
+	mStatus = status;
+
+	mTimings = HttpMetrics::getTimings(easy);
+	HttpMetrics::record(url, mTimings, status);
+
+	long connects = 0;
+	curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+	++gRequestCount;
+	gNewConnectionCount += connects;
+	long httpVersion = 0;
+	curl_easy_getinfo(easy, CURLINFO_HTTP_VERSION, &httpVersion);
+	if (httpVersion == CURL_HTTP_VERSION_2_0) {
+		++gHttp2Count;
+	}
 
-	//Clean up
-	if (mBuffer) {
-		MBX_Free(mBuffer);
+	auto active = gActiveTransfers.find(mHost);
+	if (active != gActiveTransfers.end() && --active->second == 0) {
+		gActiveTransfers.erase(active);
 	}
 
-	//Then delete the request
+	//Then put the handle back in the pool
 	curl_multi_remove_handle(gCurlMulti, easy);
 	--gCurlMultiTotal;
-	curl_easy_cleanup(easy);
+	releaseHandles();
+}
+
+/**
+ * Per-frame update for a request: progress, and sending lines.
+ * @return True once the request is done and everything has been sent.
+ */
+bool curlInfo::process(U32 time) {
+	if (!mDone) {
+		processProgress(time);
+		if (mIncremental) {
+			processLines(false);
+		}
+		return false;
+	}
+
+	if (!processLines(true)) {
+		//More next frame
+		return false;
+	}
+
+	//Clean up
+	if (mBuffer) {
+		MBX_Free(mBuffer);
+		mBuffer = nullptr;
+	}
 
 	//Send a disconnect
 	TGE::Con::executef(obj, 1, "onDisconnect");
+	return true;
 }
 
 static size_t writeCallback(char *buffer, size_t size, size_t nitems, TGE::HTTPObject *object) {
@@ -259,12 +788,8 @@ size_t headerCallback(char *buffer, size_t size, size_t nitems, TGE::HTTPObject
 MBX_OVERRIDE_MEMBERFN(TGE::HTTPObject *, TGE::ConcreteClassRep_HTTPObject::create, (TGE::ConcreteClassRep_HTTPObject *thisptr), originalCreate) {
 	TGE::HTTPObject *ret = originalCreate(thisptr);
 
-	CURL *request = curl_easy_init();
-	curl_easy_setopt(request, CURLOPT_VERBOSE, false);
-	curl_easy_setopt(request, CURLOPT_FOLLOWLOCATION, true);
-	curl_easy_setopt(request, CURLOPT_TRANSFERTEXT, true);
-	curl_easy_setopt(request, CURLOPT_USERAGENT, "Torque 1.0");
-	curl_easy_setopt(request, CURLOPT_ENCODING, "ISO 8859-1");
+	CURL *request = acquireEasyHandle();
+	RequestOptions::applyDefaults(request, gCurlShare, gHttp2);
 
 	curlInfo *info = new curlInfo;
 
@@ -292,16 +817,44 @@ MBX_CONSOLE_METHOD(HTTPObject, setOption, void, 4, 4, "HTTPObject.setOption(name
 	else if (strcasecmp(option, "user-agent") == 0) { curl_easy_setopt(easy, CURLOPT_USERAGENT, value); }
 	else if (strcasecmp(option, "cookie") == 0)     { curl_easy_setopt(easy, CURLOPT_COOKIE, value); }
 	else if (strcasecmp(option, "verify-peer") == 0){ curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, StringMath::scan<bool>(value)); }
+	else if (strcasecmp(option, "max-size") == 0)   { gInverseMap[object]->mMaxSize = strtoull(value, NULL, 10); }
+	else if (strcasecmp(option, "resume") == 0)     { gInverseMap[object]->mResume = StringMath::scan<bool>(value); }
+	else if (strcasecmp(option, "incremental") == 0) { gInverseMap[object]->mIncremental = StringMath::scan<bool>(value); }
+	else if (strcasecmp(option, "lines-per-frame") == 0) { gInverseMap[object]->mLinesPerFrame = StringMath::scan<U32>(value); }
+	else if (strcasecmp(option, "progress-interval") == 0) { gInverseMap[object]->mProgressInterval = StringMath::scan<U32>(value); }
+	else if (strcasecmp(option, "cache") == 0)      { gInverseMap[object]->mCache = StringMath::scan<bool>(value); }
+	else if (strcasecmp(option, "accept-encoding") == 0) { curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, value); }
+	else if (strcasecmp(option, "charset") == 0)    { gInverseMap[object]->mCharset = getCharset((std::string("charset=") + value).c_str()); }
+	else if (strcasecmp(option, "http-version") == 0) {
+		long version = CURL_HTTP_VERSION_NONE;
+		if      (strcmp(value, "1.0") == 0) version = CURL_HTTP_VERSION_1_0;
+		else if (strcmp(value, "1.1") == 0) version = CURL_HTTP_VERSION_1_1;
+		else if (strcmp(value, "2") == 0)   version = (gHttp2 ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_1_1);
+		curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, version);
+	}
+	else if (strcasecmp(option, "compress-body") == 0) { gInverseMap[object]->mCompressBody = StringMath::scan<bool>(value); }
 	else {
 		TGE::Con::errorf("HTTPObject::setOption unknown option %s", option);
 	}
 }
 
+MBX_CONSOLE_METHOD(HTTPObject, getTimings, const char *, 2, 2, "HTTPObject.getTimings() - Get \"dns connect tls firstByte total\" in ms for the last request") {
+	const HttpMetrics::Timings &timings = gInverseMap[object]->mTimings;
+	char *ret = TGE::Con::getReturnBuffer(128);
+	snprintf(ret, 128, "%.3f %.3f %.3f %.3f %.3f", timings.dns, timings.connect, timings.tls, timings.firstByte, timings.total);
+	return ret;
+}
+
 MBX_CONSOLE_METHOD(HTTPObject, setDownloadPath, void, 3, 3, "HTTPObject.setDownloadPath(path);") {
 	gInverseMap[object]->download = *argv[2];
 	if (*argv[2]) {
 		char expanded[0x100];
 		TGE::Con::expandScriptFilename(expanded, 0x100, argv[2]);
+		if (!isValidDownloadPath(expanded)) {
+			TGE::Con::errorf("HTTPObject::setDownloadPath: Cannot download to %s", expanded);
+			gInverseMap[object]->download = false;
+			return;
+		}
 		gInverseMap[object]->downloadPath = expanded;
 	}
 }
@@ -347,6 +900,29 @@ MBX_OVERRIDE_FN(void, TGE::cHTTPObjectGet, (TGE::HTTPObject *thisptr, int argc,
 	info->url = std::string(address) + uri + (query ? std::string("?") + query : "");
 	curl_easy_setopt(info->easy, CURLOPT_URL, info->url.c_str());
 
+	//Downloads and incremental requests don't keep the body around to store
+	if (info->mCache && !info->download && !info->mIncremental && HttpCache::isEnabled()) {
+		info->mCacheable = true;
+		if (HttpCache::load(info->url, info->mCached)) {
+			if (info->mCached.expires > time(NULL)) {
+				info->serveCached();
+				return;
+			}
+
+			//Stale, ask the server if it has changed
+			if (!info->mCached.etag.empty()) {
+				std::string header = "If-None-Match: " + info->mCached.etag;
+				info->headers = curl_slist_append(info->headers, header.c_str());
+				info->mHasCached = true;
+			}
+			if (!info->mCached.lastModified.empty()) {
+				std::string header = "If-Modified-Since: " + info->mCached.lastModified;
+				info->headers = curl_slist_append(info->headers, header.c_str());
+				info->mHasCached = true;
+			}
+		}
+	}
+
 	info->start();
 }
 
@@ -363,8 +939,20 @@ MBX_OVERRIDE_FN(void, TGE::cHTTPObjectPost, (TGE::HTTPObject *thisptr, int argc,
 	info->url = std::string(address) + uri + (*query ? std::string("?") + query : "");
 	info->values = post;
 
+	if (info->mCompressBody) {
+		std::string compressed;
+		if (gzipCompress(info->values, compressed)) {
+			info->values.swap(compressed);
+			info->headers = curl_slist_append(info->headers, "Content-Encoding: gzip");
+		} else {
+			TGE::Con::errorf("HTTPObject::post: Could not compress request body, sending it uncompressed");
+		}
+	}
+
 	curl_easy_setopt(info->easy, CURLOPT_URL, info->url.c_str());
 	curl_easy_setopt(info->easy, CURLOPT_POST, true);
+	//Compressed bodies can have zeroes in them
+	curl_easy_setopt(info->easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(info->values.size()));
 	curl_easy_setopt(info->easy, CURLOPT_POSTFIELDS, info->values.c_str());
 
 	info->start();
@@ -377,36 +965,88 @@ MBX_ON_CLIENT_PROCESS(clientProcess, (uint32_t delta)) {
 		TGE::Con::errorf("curl_multi_perform failed (%d): %s", code, curl_multi_strerror(code));
 		return;
 	}
-	if (runningHandles >= gCurlMultiTotal) {
-		return;
-	}
-	while (true) {
-		int queueSize = 0;
-		CURLMsg *msg = curl_multi_info_read(gCurlMulti, &queueSize);
-		if (!msg) {
-			break;
-		}
-		if (msg->msg != CURLMSG_DONE) {
-			continue;
+
+	if (runningHandles < gCurlMultiTotal) {
+		while (true) {
+			int queueSize = 0;
+			CURLMsg *msg = curl_multi_info_read(gCurlMulti, &queueSize);
+			if (!msg) {
+				break;
+			}
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			auto it = gCurlMap.find(msg->easy_handle);
+			if (it == gCurlMap.end()) {
+				continue;
+			}
+			//The easy handle goes back in the pool, so it's removed from the map
+			// before anything can reuse it
+			curlInfo *info = it->second;
+			gCurlMap.erase(it);
+			info->finish(msg->data.result);
+			gFinishingRequests.push_back(info);
 		}
-		auto it = gCurlMap.find(msg->easy_handle);
-		if (it == gCurlMap.end()) {
-			continue;
+		startWaitingRequests();
+	}
+
+	//Lines and progress are sent from here rather than curl's callbacks so
+	// scripts can't reenter curl. Script can create new requests from these
+	// callbacks, so work from a copy.
+	U32 time = TGE::Platform::getRealMilliseconds();
+	std::vector<curlInfo *> active;
+	active.reserve(gCurlMap.size());
+	for (auto it = gCurlMap.begin(); it != gCurlMap.end(); ++it) {
+		active.push_back(it->second);
+	}
+	for (curlInfo *info : active) {
+		info->process(time);
+	}
+
+	std::vector<curlInfo *> finishing;
+	finishing.swap(gFinishingRequests);
+	for (curlInfo *info : finishing) {
+		if (info->process(time)) {
+			gInverseMap.erase(info->obj);
+			delete info;
+		} else {
+			gFinishingRequests.push_back(info);
 		}
-		it->second->finish(msg->data.result);
-		gInverseMap.erase(it->second->obj);
-		delete it->second;
-		gCurlMap.erase(it);
 	}
 }
 
+MBX_CONSOLE_FUNCTION(httpSetConnectionLimits, void, 2, 4, "httpSetConnectionLimits(perHost[, total[, transfersPerHost]]) - Limit how many connections HTTPObjects open, and how many requests run at once to one host. 0 for no limit.") {
+	curl_multi_setopt(gCurlMulti, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(StringMath::scan<U32>(argv[1])));
+	if (argc > 2) {
+		curl_multi_setopt(gCurlMulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(StringMath::scan<U32>(argv[2])));
+	}
+	if (argc > 3) {
+		gMaxTransfersPerHost = StringMath::scan<U32>(argv[3]);
+		startWaitingRequests();
+	}
+}
+
+MBX_CONSOLE_FUNCTION(httpGetConnectionStats, const char *, 1, 1, "httpGetConnectionStats() - Get \"requests newConnections http2Requests\" for all finished HTTPObject requests") {
+	char *ret = TGE::Con::getReturnBuffer(48);
+	snprintf(ret, 48, "%u %u %u", gRequestCount, gNewConnectionCount, gHttp2Count);
+	return ret;
+}
+
 bool initPlugin(MBX::Plugin &plugin)
 {
-	gCurlMulti = curl_multi_init();
+	gHttp2 = (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) != 0;
+	gCurlMulti = RequestOptions::createMulti(gHttp2);
 	if (!gCurlMulti) {
 		return false;
 	}
 
+	gCurlShare = RequestOptions::createShare();
+	if (!gCurlShare) {
+		return false;
+	}
+
 	MBX_INSTALL(plugin, TLSSupport);
+	MBX_INSTALL(plugin, HttpCache);
+	MBX_INSTALL(plugin, HttpMetrics);
 	return true;
 }
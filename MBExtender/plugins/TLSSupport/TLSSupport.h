@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// TLSSupport.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+
+//File helpers shared by the TLSSupport modules
+
+/**
+ * Check if a download can be written to a path. Same rules as the resource
+ * manager uses for openFileForWrite.
+ */
+bool isValidDownloadPath(const std::string &path);
+
+/**
+ * Create all of the directories leading up to a file.
+ */
+void createParentDirectories(const std::string &path);
+
+/**
+ * Get the host (and port, if given) out of a URL.
+ */
+std::string getUrlHost(const std::string &url);
+
+/**
+ * Move a finished file into place, replacing anything already there.
+ */
+bool replaceFile(const std::string &from, const std::string &to);
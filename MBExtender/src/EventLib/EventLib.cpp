@@ -25,6 +25,7 @@
 #include <EventLib/EventLib.h>
 
 #include <unordered_map>
+#include <vector>
 
 #include <MBExtender/MBExtender.h>
 #include <TorqueLib/console/console.h>
@@ -47,26 +48,6 @@ namespace TGE {
 		//Technically this one is NetEvent::notifyDelivered, but we override it so we can use it.
 		// Also, the default implementation has no code in it, so it's not like we're breaking anything.
 		MEMBERFN(void, notifyDelivered, (NetConnection *connection, bool madeIt), 0x407AF9_win, 0x19A240_mac);
-
-	public:
-		/**
-		 * Create a SimpleMessageEvent using a MarbleEvent's info
-		 * @param mevent A MarbleEvent containing event info
-		 * @return A new SimpleMessageEvent
-		 */
-		static SimpleMessageEvent *create(CustomNetEvent *mevent);
-		/**
-		 * Get the associated MarbleEvent for a SimpleMessageEvent
-		 * @param event The SimpleMessageEvent
-		 * @return The event's MarbleEvent, or null if none is assigned
-		 */
-		static CustomNetEvent *getClientEvent(SimpleMessageEvent *event);
-		/**
-		 * Get the associated MarbleEvent for a SimpleMessageEvent
-		 * @param event The SimpleMessageEvent
-		 * @return The event's MarbleEvent, or null if none is assigned
-		 */
-		static CustomNetEvent *getServerEvent(SimpleMessageEvent *event);
 	};
 
 	namespace ConcreteClassRepSimpleMessageEvent {
@@ -76,56 +57,169 @@ namespace TGE {
 	FN(void, cMsg, (TGE::SimObject *object, S32 argc, const char **argv), 0x48A3E0_win, 0xCFF40_mac);
 }
 
-std::unordered_map<TGE::SimpleMessageEvent *, CustomNetEvent *> gServerEventMap{};
-std::unordered_map<TGE::SimpleMessageEvent *, CustomNetEvent *> gClientEventMap{};
+//Every SimpleMessageEvent carries a batch of one or more CustomNetEvents. The
+// wire format is the number of events followed by each event's type and data.
+static const U32 TypeBits = 16;
+static const U32 CountBits = 8;
+static const U32 MaxBatchEvents = 1 << CountBits;
+
+struct EventBatch {
+	std::vector<CustomNetEvent *> events;
+	//Key into gOpenBatches
+	U64 key;
+	//Upper bound on the packed size so far
+	U32 bits;
+};
+
+std::unordered_map<TGE::SimpleMessageEvent *, EventBatch *> gEventBatches{};
+//Batches which have been posted but not packed yet, so more small events can
+// still be added to them. Keyed by connection id and guarantee type.
+std::unordered_map<U64, TGE::SimpleMessageEvent *> gOpenBatches{};
+std::vector<EventBatch *> gBatchPool{};
+
+//Most bits one batch can take up, 0 to send every event by itself. Leaves room
+// in the packet for ghost updates.
+U32 gMaxBatchBits = 4000;
+
+//Stats for eventLibGetStats()
+U32 gPostedEvents = 0;
+U32 gPostedBatches = 0;
 
 //Making this a pointer is stupid but it keeps being reset and I can't find why
-std::unordered_map<U8, AbstractCustomEventConstructor *> *gEventConstructors = nullptr;
+std::vector<AbstractCustomEventConstructor *> *gEventConstructors = nullptr;
 
-namespace TGE {
+static U64 getBatchKey(TGE::NetConnection *connection, TGE::NetEvent::GuaranteeType guarantee) {
+	return (static_cast<U64>(connection->getId()) << 2) | static_cast<U64>(guarantee);
+}
 
-	SimpleMessageEvent *SimpleMessageEvent::create(CustomNetEvent *mevent) {
-		//We can't instantiate stuff with new <class> so we just use steal the class rep's
-		SimpleMessageEvent *event = ConcreteClassRepSimpleMessageEvent::create();
+static EventBatch *acquireBatch() {
+	if (gBatchPool.empty()) {
+		return new EventBatch;
+	}
+	EventBatch *batch = gBatchPool.back();
+	gBatchPool.pop_back();
+	return batch;
+}
 
-		//Set up the connections
-		gServerEventMap[event] = mevent;
+static void releaseBatch(EventBatch *batch) {
+	batch->events.clear();
+	gBatchPool.push_back(batch);
+}
 
-		//Just pretend it worked, we know it did
-		return event;
-	}
+static EventBatch *findBatch(TGE::SimpleMessageEvent *event) {
+	auto found = gEventBatches.find(event);
+	if (found == gEventBatches.end())
+		return nullptr;
+	return found->second;
+}
 
-	CustomNetEvent *SimpleMessageEvent::getClientEvent(SimpleMessageEvent *event) {
-		if (gClientEventMap.find(event) != gClientEventMap.end()) {
-			return gClientEventMap[event];
-		}
-		return NULL;
+/**
+ * Stop adding events to a batch, once it has been written to a packet.
+ */
+static void closeBatch(TGE::SimpleMessageEvent *event, EventBatch *batch) {
+	auto open = gOpenBatches.find(batch->key);
+	if (open != gOpenBatches.end() && open->second == event) {
+		gOpenBatches.erase(open);
 	}
+}
 
-	CustomNetEvent *SimpleMessageEvent::getServerEvent(SimpleMessageEvent *event) {
-		if (gServerEventMap.find(event) != gServerEventMap.end()) {
-			return gServerEventMap[event];
-		}
-		return NULL;
-	}
+/**
+ * Stop adding events to all of a connection's batches, so nothing posted
+ * after this point can be sent ahead of what was posted before it.
+ */
+static void closeConnectionBatches(TGE::NetConnection *connection) {
+	gOpenBatches.erase(getBatchKey(connection, TGE::NetEvent::GuaranteedOrdered));
+	gOpenBatches.erase(getBatchKey(connection, TGE::NetEvent::Guaranteed));
+	gOpenBatches.erase(getBatchKey(connection, TGE::NetEvent::Unguaranteed));
+}
+
+static AbstractCustomEventConstructor *findConstructor(U32 type) {
+	if (gEventConstructors == nullptr || type >= gEventConstructors->size())
+		return nullptr;
+	return (*gEventConstructors)[type];
+}
 
+static void destroyEvent(CustomNetEvent *cevent) {
+	AbstractCustomEventConstructor *ctor = findConstructor(cevent->_type);
+	if (ctor != nullptr) {
+		ctor->destroy(cevent);
+	} else {
+		delete cevent;
+	}
 }
 
 U32 registerEventConstructor(AbstractCustomEventConstructor *constructor) {
 	if (gEventConstructors == nullptr) {
-		gEventConstructors = new std::unordered_map<U8, AbstractCustomEventConstructor *>;
+		gEventConstructors = new std::vector<AbstractCustomEventConstructor *>;
 	}
 	U32 type = gEventConstructors->size();
-	gEventConstructors->insert({type, constructor});
+	if (type >= (1 << TypeBits)) {
+		TGE::Con::errorf("Too many custom net event types!");
+	}
+	gEventConstructors->push_back(constructor);
 
 	return type;
 }
 
 bool postCustomNetEvent(CustomNetEvent *event, TGE::NetConnection *connection, TGE::NetEvent::GuaranteeType guarantee) {
+	U64 key = getBatchKey(connection, guarantee);
+	U32 bits = event->getMaxPackedBits();
+	bool batchable = (gMaxBatchBits != 0 && bits != CustomNetEvent::UnknownSize);
+	gPostedEvents++;
+
+	if (batchable) {
+		bits += TypeBits;
+
+		//Add it to the batch that's waiting for a packet if there is room
+		auto open = gOpenBatches.find(key);
+		if (open != gOpenBatches.end()) {
+			EventBatch *batch = findBatch(open->second);
+			if (batch != nullptr && batch->bits + bits <= gMaxBatchBits && batch->events.size() < MaxBatchEvents) {
+				batch->events.push_back(event);
+				batch->bits += bits;
+				return true;
+			}
+			gOpenBatches.erase(open);
+		}
+	} else {
+		//Nothing can be added after this one without reordering them
+		gOpenBatches.erase(key);
+	}
+
 	//Create and send an event
-	TGE::SimpleMessageEvent *smevent = TGE::SimpleMessageEvent::create(event);
+	//We can't instantiate stuff with new <class> so we just use steal the class rep's
+	TGE::SimpleMessageEvent *smevent = TGE::ConcreteClassRepSimpleMessageEvent::create();
 	smevent->mGuaranteeType() = guarantee;
-	return connection->postNetEvent(smevent);
+
+	EventBatch *batch = acquireBatch();
+	batch->events.push_back(event);
+	batch->key = key;
+	batch->bits = (batchable ? CountBits + bits : 0);
+	gEventBatches[smevent] = batch;
+
+	if (!connection->postNetEvent(smevent)) {
+		//The connection already freed smevent, and the caller still has the event
+		gEventBatches.erase(smevent);
+		releaseBatch(batch);
+		return false;
+	}
+	gPostedBatches++;
+
+	if (batchable) {
+		gOpenBatches[key] = smevent;
+	}
+	return true;
+}
+
+/**
+ * Engine events (commandToClient and friends) are posted in between ours, so
+ * custom events posted after one can't be added to a batch from before it.
+ */
+MBX_OVERRIDE_MEMBERFN(bool, TGE::NetConnection::postNetEvent, (TGE::NetConnection *thisptr, TGE::NetEvent *event), originalPostNetEvent) {
+	if (gEventBatches.find(static_cast<TGE::SimpleMessageEvent *>(event)) == gEventBatches.end()) {
+		closeConnectionBatches(thisptr);
+	}
+	return originalPostNetEvent(thisptr, event);
 }
 
 MBX_OVERRIDE_FN(void, TGE::cMsg, (TGE::SimObject *object, S32 argc, const char **argv), originalCmsg) {
@@ -134,92 +228,116 @@ MBX_OVERRIDE_FN(void, TGE::cMsg, (TGE::SimObject *object, S32 argc, const char *
 	TGE::Con::printf("Don't use this!");
 }
 
+static void packBatch(TGE::SimpleMessageEvent *event, TGE::NetConnection *connection, TGE::BitStream *stream) {
+	EventBatch *batch = findBatch(event);
+	if (batch == nullptr) {
+		TGE::Con::errorf("Could not find event we sent?");
+		return;
+	}
+
+	//Packing can happen more than once if the packet is full, so the batch
+	// has to stay the same from here on
+	closeBatch(event, batch);
+
+	stream->writeInt(batch->events.size() - 1, CountBits);
+	for (CustomNetEvent *cevent : batch->events) {
+		stream->writeInt(cevent->_type, TypeBits);
+		if (!cevent->pack(connection, stream)) {
+			TGE::Con::errorf("Event pack failed!");
+		}
+	}
+}
+
 /**
  * Write the event's details to the client
  */
 MBX_OVERRIDE_MEMBERFN(void, TGE::SimpleMessageEvent::pack, (TGE::SimpleMessageEvent *event, TGE::NetConnection *connection, TGE::BitStream *stream), originalPack) {
-	CustomNetEvent *cevent = TGE::SimpleMessageEvent::getServerEvent(event);
-
-	if (cevent != nullptr) {
-		stream->writeInt(cevent->_type, 8);
-		cevent->pack(connection, stream);
-	} else {
-		TGE::Con::errorf("Could not find event we sent?");
-	}
+	packBatch(event, connection, stream);
 }
 
 /**
  * Seems to just be a copy of ::pack. Not sure it's ever called but better to be safe.
  */
 MBX_OVERRIDE_MEMBERFN(void, TGE::SimpleMessageEvent::write, (TGE::SimpleMessageEvent *event, TGE::NetConnection *connection, TGE::BitStream *stream), originalWrite) {
-	CustomNetEvent *cevent = TGE::SimpleMessageEvent::getServerEvent(event);
-
-	if (cevent != nullptr) {
-		stream->writeInt(cevent->_type, 8);
-		if (!cevent->pack(connection, stream)) {
-			TGE::Con::errorf("Event pack failed!");
-		}
-	} else {
-		TGE::Con::errorf("Could not find event we sent?");
-	}
+	packBatch(event, connection, stream);
 }
 
 MBX_OVERRIDE_MEMBERFN(void, TGE::SimpleMessageEvent::unpack, (TGE::SimpleMessageEvent *event, TGE::NetConnection *connection, TGE::BitStream *stream), originalUnpack) {
-	U8 eventType = stream->readInt(8);
-
-	//Get the constructor
-	auto found = gEventConstructors->find(eventType);
-	if (found != gEventConstructors->end()) {
-		AbstractCustomEventConstructor *ctor = found->second;
+	EventBatch *batch = acquireBatch();
+	batch->key = 0;
+	batch->bits = 0;
+	gEventBatches[event] = batch;
+
+	U32 count = stream->readInt(CountBits) + 1;
+	for (U32 i = 0; i < count; i++) {
+		U32 eventType = stream->readInt(TypeBits);
+
+		//Get the constructor
+		AbstractCustomEventConstructor *ctor = findConstructor(eventType);
+		if (ctor == nullptr) {
+			//Can't tell where the next event starts
+			TGE::Con::errorf("Could not find event we sent?");
+			break;
+		}
 
 		CustomNetEvent *cevent = ctor->create();
-		gClientEventMap[event] = cevent;
+		batch->events.push_back(cevent);
 
 		if (!cevent->unpack(connection, stream)) {
 			TGE::Con::errorf("Event unpack failed!");
 		}
-	} else {
-		TGE::Con::errorf("Could not find event we sent?");
 	}
 }
 
 MBX_OVERRIDE_MEMBERFN(void, TGE::SimpleMessageEvent::process, (TGE::SimpleMessageEvent *event, TGE::NetConnection *connection), originalProcess) {
-	CustomNetEvent *cevent = TGE::SimpleMessageEvent::getClientEvent(event);
-
-	if (cevent) {
-		if (cevent->process(connection)) {
-			gClientEventMap.erase(gClientEventMap.find(event));
+	auto found = gEventBatches.find(event);
+	if (found == gEventBatches.end()) {
+		TGE::Con::errorf("Could not find event we sent?");
+		return;
+	}
+	EventBatch *batch = found->second;
+	gEventBatches.erase(found);
 
-			auto found = gEventConstructors->find(cevent->_type);
-			if (found != gEventConstructors->end()) {
-				AbstractCustomEventConstructor *ctor = found->second;
-				delete cevent;
-			}
-		} else {
+	for (CustomNetEvent *cevent : batch->events) {
+		if (!cevent->process(connection)) {
 			TGE::Con::errorf("Event process failed!");
 		}
-	} else {
-		TGE::Con::errorf("Could not find event we sent?");
+		destroyEvent(cevent);
 	}
+	releaseBatch(batch);
 }
 
 MBX_OVERRIDE_MEMBERFN(void, TGE::SimpleMessageEvent::notifyDelivered, (TGE::SimpleMessageEvent *event, TGE::NetConnection *connection, bool madeIt), originalNotifyDelivered) {
 	//Actually an override of NetEvent::notifyDelivered
-	auto found = gServerEventMap.find(event);
-	if (found != gServerEventMap.end()) {
-		CustomNetEvent *cevent = found->second;
-		cevent->notifyDelivered(connection, madeIt);
-
-		//Clean up
-		gServerEventMap.erase(found);
-		auto found2 = gEventConstructors->find(cevent->_type);
-		if (found2 != gEventConstructors->end()) {
-			AbstractCustomEventConstructor *ctor = found2->second;
-			delete cevent;
+	auto found = gEventBatches.find(event);
+	if (found != gEventBatches.end()) {
+		EventBatch *batch = found->second;
+		closeBatch(event, batch);
+		gEventBatches.erase(found);
+
+		for (CustomNetEvent *cevent : batch->events) {
+			cevent->notifyDelivered(connection, madeIt);
+
+			//Clean up
+			destroyEvent(cevent);
 		}
+		releaseBatch(batch);
 	}
 }
 
+MBX_CONSOLE_FUNCTION(eventLibSetBatchLimit, void, 2, 2, "eventLibSetBatchLimit(bits) - Most bits small custom net events sent together can use, 0 to send each by itself") {
+	gMaxBatchBits = strtoul(argv[1], NULL, 10);
+	if (gMaxBatchBits == 0) {
+		gOpenBatches.clear();
+	}
+}
+
+MBX_CONSOLE_FUNCTION(eventLibGetStats, const char *, 1, 1, "eventLibGetStats() - Get \"events netEvents\", how many custom events were posted and how many net events carried them") {
+	char *ret = TGE::Con::getReturnBuffer(32);
+	snprintf(ret, 32, "%u %u", gPostedEvents, gPostedBatches);
+	return ret;
+}
+
 bool initEventLib(MBX::Plugin &plugin)
 {
 	MBX_INSTALL(plugin, EventLib);
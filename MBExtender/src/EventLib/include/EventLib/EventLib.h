@@ -25,6 +25,8 @@
 #pragma once
 
 #include <TorqueLib/sim/netConnection.h>
+#include <new>
+#include <vector>
 
 #ifdef _WIN32
 	#ifdef EventLib_EXPORTS
@@ -84,9 +86,12 @@ protected:
 	 */
 	CustomNetEvent() : _type(0) {}
 public:
-	//U8 is probably big enough
-	// (if this is not big enough then you need to rethink your life choices)
-	U8 _type;
+	U16 _type;
+
+	/**
+	 * Returned from getMaxPackedBits() if the size isn't known ahead of time.
+	 */
+	static const U32 UnknownSize = 0xFFFFFFFF;
 
 	/**
 	 * [SERVER] Send the event to a client
@@ -122,6 +127,16 @@ public:
 	 * @param madeIt If the event was actually delivered
 	 */
 	virtual void notifyDelivered(TGE::NetConnection *connection, bool madeIt) = 0;
+	/**
+	 * [SERVER] The most bits pack() can write for this event. Events that
+	 * know their size can share one net event with other small events posted
+	 * to the same connection before the next packet goes out.
+	 * @return An upper bound on the packed size, or UnknownSize to always send
+	 *         the event by itself
+	 */
+	virtual U32 getMaxPackedBits() const {
+		return UnknownSize;
+	}
 
 	virtual ~CustomNetEvent() {}
 };
@@ -138,6 +153,12 @@ public:
 	 * @return A new event
 	 */
 	virtual CustomNetEvent *create() = 0;
+	/**
+	 * Destroy an event made by create(). Called by EventLib once the event has
+	 * been delivered or processed.
+	 * @param event The event to destroy
+	 */
+	virtual void destroy(CustomNetEvent *event) = 0;
 };
 
 /**
@@ -166,8 +187,35 @@ public:
 	 * @return A new event
 	 */
 	EventType *createSubtype() {
-		EventType *event = new EventType;
+		//Events are sent every tick, so their memory is reused instead of
+		// going back to the allocator each time
+		void *memory;
+		if (_pool.empty()) {
+			memory = ::operator new(sizeof(EventType));
+		} else {
+			memory = _pool.back();
+			_pool.pop_back();
+		}
+		EventType *event = new (memory) EventType;
 		event->_type = _type;
 		return event;
 	}
+
+	/**
+	 * Destroy an event made by create() and keep its memory for the next one.
+	 * @param event The event to destroy
+	 */
+	void destroy(CustomNetEvent *event) override {
+		EventType *typed = static_cast<EventType *>(event);
+		typed->~EventType();
+		if (_pool.size() < MaxPooled) {
+			_pool.push_back(typed);
+		} else {
+			::operator delete(typed);
+		}
+	}
+
+private:
+	static const size_t MaxPooled = 64;
+	std::vector<void *> _pool;
 };
@@ -0,0 +1,475 @@
+//-----------------------------------------------------------------------------
+// TestServer.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "TestServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+//How often blocked sockets check if the server is stopping
+static const int PollMs = 50;
+
+//One client connection, plain or TLS
+struct TestServer::Connection {
+	int socket;
+	SSL *ssl;
+	const std::atomic<bool> *running;
+	//Read but not yet parsed
+	std::string buffer;
+
+	/**
+	 * Read some more data into the buffer.
+	 * @return False once the connection is closed or the server stops.
+	 */
+	bool fill() {
+		char data[16 * 1024];
+		while (running->load()) {
+			if (ssl == nullptr || SSL_pending(ssl) == 0) {
+				pollfd fd = {socket, POLLIN, 0};
+				int ready = poll(&fd, 1, PollMs);
+				if (ready < 0)
+					return false;
+				if (ready == 0)
+					continue;
+			}
+			int read;
+			if (ssl != nullptr) {
+				read = SSL_read(ssl, data, sizeof(data));
+				if (read <= 0) {
+					int error = SSL_get_error(ssl, read);
+					if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+						continue;
+					return false;
+				}
+			} else {
+				read = static_cast<int>(recv(socket, data, sizeof(data), 0));
+				if (read <= 0)
+					return false;
+			}
+			buffer.append(data, read);
+			return true;
+		}
+		return false;
+	}
+
+	bool write(const char *data, size_t length) {
+		while (length > 0) {
+			int written;
+			if (ssl != nullptr) {
+				written = SSL_write(ssl, data, static_cast<int>(length));
+			} else {
+				written = static_cast<int>(send(socket, data, length, MSG_NOSIGNAL));
+			}
+			if (written <= 0)
+				return false;
+			data += written;
+			length -= written;
+		}
+		return true;
+	}
+
+	bool write(const std::string &data) {
+		return write(data.data(), data.size());
+	}
+};
+
+static void sleepMs(int ms) {
+	if (ms > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+}
+
+static std::string toLower(std::string str) {
+	std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+	return str;
+}
+
+static const char *getReason(int status) {
+	switch (status) {
+		case 200: return "OK";
+		case 206: return "Partial Content";
+		case 301: return "Moved Permanently";
+		case 302: return "Found";
+		case 304: return "Not Modified";
+		case 404: return "Not Found";
+		case 416: return "Range Not Satisfiable";
+		case 500: return "Internal Server Error";
+		case 503: return "Service Unavailable";
+		default: return "Unknown";
+	}
+}
+
+/**
+ * Gzip a response body.
+ */
+static bool gzipCompress(const std::string &data, std::string &compressed) {
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	//15 window bits, +16 for a gzip header instead of a zlib one
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	compressed.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	stream.avail_in = static_cast<uInt>(data.size());
+	stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+	stream.avail_out = static_cast<uInt>(compressed.size());
+
+	int result = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	return result == Z_STREAM_END;
+}
+
+TestServer::TestServer() : mRunning(false), mConnections(0) {
+}
+
+TestServer::~TestServer() {
+	stop();
+	if (mSslContext != nullptr) {
+		SSL_CTX_free(mSslContext);
+	}
+}
+
+/**
+ * Make a key and a self-signed certificate for localhost and 127.0.0.1.
+ */
+bool TestServer::createCertificate() {
+	EVP_PKEY *key = nullptr;
+	EVP_PKEY_CTX *keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+	bool ok = (keyContext != nullptr
+		&& EVP_PKEY_keygen_init(keyContext) > 0
+		&& EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) > 0
+		&& EVP_PKEY_keygen(keyContext, &key) > 0);
+	EVP_PKEY_CTX_free(keyContext);
+	if (!ok)
+		return false;
+
+	X509 *cert = X509_new();
+	X509_set_version(cert, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+	X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+	X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 60 * 60);
+	X509_set_pubkey(cert, key);
+
+	X509_NAME *name = X509_get_subject_name(cert);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+	X509_set_issuer_name(cert, name);
+
+	//Self-signed, so it's its own CA. curl checks the names against the SAN.
+	X509V3_CTX extContext;
+	X509V3_set_ctx_nodb(&extContext);
+	X509V3_set_ctx(&extContext, cert, cert, nullptr, nullptr, 0);
+	const char *extensions[][2] = {
+		{"basicConstraints", "critical,CA:TRUE"},
+		{"subjectAltName", "DNS:localhost,IP:127.0.0.1"}
+	};
+	for (const auto &extension : extensions) {
+		X509_EXTENSION *ext = X509V3_EXT_conf(nullptr, &extContext, extension[0], extension[1]);
+		ok = ok && ext != nullptr && X509_add_ext(cert, ext, -1);
+		X509_EXTENSION_free(ext);
+	}
+	ok = ok && X509_sign(cert, key, EVP_sha256()) > 0;
+
+	if (ok) {
+		mSslContext = SSL_CTX_new(TLS_server_method());
+		ok = (mSslContext != nullptr
+			&& SSL_CTX_use_certificate(mSslContext, cert) == 1
+			&& SSL_CTX_use_PrivateKey(mSslContext, key) == 1);
+	}
+	if (ok) {
+		BIO *bio = BIO_new(BIO_s_mem());
+		PEM_write_bio_X509(bio, cert);
+		char *pem;
+		long length = BIO_get_mem_data(bio, &pem);
+		mCertificate.assign(pem, length);
+		BIO_free(bio);
+	}
+
+	X509_free(cert);
+	EVP_PKEY_free(key);
+	return ok;
+}
+
+bool TestServer::start(bool tls) {
+	mTls = tls;
+	if (tls && mSslContext == nullptr && !createCertificate()) {
+		fprintf(stderr, "TestServer: Could not create a certificate\n");
+		return false;
+	}
+
+	mListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (mListenSocket < 0)
+		return false;
+
+	//Port 0 picks a free one
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	socklen_t length = sizeof(address);
+	if (bind(mListenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+		|| listen(mListenSocket, 64) != 0
+		|| getsockname(mListenSocket, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+		close(mListenSocket);
+		mListenSocket = -1;
+		return false;
+	}
+	mPort = ntohs(address.sin_port);
+
+	mRunning = true;
+	mAcceptThread = std::thread(&TestServer::acceptLoop, this);
+	return true;
+}
+
+void TestServer::stop() {
+	if (!mRunning.exchange(false))
+		return;
+	mAcceptThread.join();
+	//Connections notice the server stopping at their next poll
+	for (std::thread &thread : mConnectionThreads) {
+		thread.join();
+	}
+	mConnectionThreads.clear();
+	close(mListenSocket);
+	mListenSocket = -1;
+}
+
+void TestServer::route(const std::string &path, const Response &response) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mRoutes[path] = response;
+}
+
+TestServer::Request TestServer::lastRequest(const std::string &path) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mRequests[path];
+}
+
+std::string TestServer::getUrl() const {
+	return std::string(mTls ? "https" : "http") + "://localhost:" + std::to_string(mPort);
+}
+
+void TestServer::acceptLoop() {
+	while (mRunning.load()) {
+		pollfd fd = {mListenSocket, POLLIN, 0};
+		if (poll(&fd, 1, PollMs) <= 0)
+			continue;
+		int client = accept(mListenSocket, nullptr, nullptr);
+		if (client < 0)
+			continue;
+		//Headers and body are written separately, don't let Nagle hold the body back
+		int noDelay = 1;
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+		++mConnections;
+		mConnectionThreads.push_back(std::thread(&TestServer::serve, this, client));
+	}
+}
+
+/**
+ * Answer requests on one connection until the client or the server closes it.
+ */
+void TestServer::serve(int socket) {
+	Connection connection;
+	connection.socket = socket;
+	connection.ssl = nullptr;
+	connection.running = &mRunning;
+
+	if (mTls) {
+		connection.ssl = SSL_new(mSslContext);
+		SSL_set_fd(connection.ssl, socket);
+		if (SSL_accept(connection.ssl) != 1) {
+			SSL_free(connection.ssl);
+			close(socket);
+			return;
+		}
+	}
+
+	bool open = true;
+	while (open) {
+		//Headers
+		size_t end;
+		while ((end = connection.buffer.find("\r\n\r\n")) == std::string::npos) {
+			if (!connection.fill()) {
+				open = false;
+				break;
+			}
+		}
+		if (!open)
+			break;
+
+		Request request;
+		std::string head = connection.buffer.substr(0, end);
+		connection.buffer.erase(0, end + 4);
+
+		size_t lineEnd = head.find("\r\n");
+		std::string requestLine = head.substr(0, lineEnd);
+		size_t space = requestLine.find(' ');
+		size_t space2 = requestLine.find(' ', space + 1);
+		request.method = requestLine.substr(0, space);
+		request.path = requestLine.substr(space + 1, space2 - space - 1);
+
+		while (lineEnd != std::string::npos) {
+			size_t start = lineEnd + 2;
+			lineEnd = head.find("\r\n", start);
+			std::string line = head.substr(start, lineEnd == std::string::npos ? std::string::npos : lineEnd - start);
+			size_t colon = line.find(':');
+			if (colon == std::string::npos)
+				continue;
+			size_t value = line.find_first_not_of(' ', colon + 1);
+			request.headers[toLower(line.substr(0, colon))] = (value == std::string::npos ? "" : line.substr(value));
+		}
+
+		//Body
+		auto contentLength = request.headers.find("content-length");
+		if (contentLength != request.headers.end()) {
+			size_t length = strtoul(contentLength->second.c_str(), nullptr, 10);
+			while (connection.buffer.size() < length) {
+				if (!connection.fill()) {
+					open = false;
+					break;
+				}
+			}
+			if (!open)
+				break;
+			request.body = connection.buffer.substr(0, length);
+			connection.buffer.erase(0, length);
+		}
+
+		open = handleRequest(connection, request);
+	}
+
+	if (connection.ssl != nullptr) {
+		SSL_shutdown(connection.ssl);
+		SSL_free(connection.ssl);
+	}
+	close(socket);
+}
+
+/**
+ * Send the scripted response for a request.
+ * @return If the connection can be used for another request.
+ */
+bool TestServer::handleRequest(Connection &connection, const Request &request) {
+	Response response;
+	bool found;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRequests[request.path] = request;
+		auto route = mRoutes.find(request.path);
+		found = (route != mRoutes.end());
+		if (found) {
+			response = route->second;
+		}
+	}
+	if (!found) {
+		response.status = 404;
+		response.body = "Not found";
+	}
+	if (response.echo) {
+		response.body = request.body;
+	}
+
+	sleepMs(response.delayMs);
+
+	std::string body = response.body;
+	std::string headers;
+	int status = response.status;
+
+	auto range = request.headers.find("range");
+	if (response.ranges) {
+		headers += "Accept-Ranges: bytes\r\n";
+		if (range != request.headers.end() && range->second.compare(0, 6, "bytes=") == 0) {
+			size_t from = strtoul(range->second.c_str() + 6, nullptr, 10);
+			if (from >= body.size()) {
+				status = 416;
+				headers += "Content-Range: bytes */" + std::to_string(body.size()) + "\r\n";
+				body.clear();
+			} else {
+				status = 206;
+				headers += "Content-Range: bytes " + std::to_string(from) + "-" + std::to_string(body.size() - 1) + "/" + std::to_string(body.size()) + "\r\n";
+				body.erase(0, from);
+			}
+		}
+	}
+
+	auto encoding = request.headers.find("accept-encoding");
+	if (response.gzip && encoding != request.headers.end() && encoding->second.find("gzip") != std::string::npos) {
+		std::string compressed;
+		if (gzipCompress(body, compressed)) {
+			body.swap(compressed);
+			headers += "Content-Encoding: gzip\r\n";
+		}
+	}
+
+	for (const auto &header : response.headers) {
+		headers += header.first + ": " + header.second + "\r\n";
+	}
+	if (response.chunkSize != 0) {
+		headers += "Transfer-Encoding: chunked\r\n";
+	} else {
+		headers += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+	}
+
+	std::string head = "HTTP/1.1 " + std::to_string(status) + " " + getReason(status) + "\r\n" + headers + "\r\n";
+	if (!connection.write(head))
+		return false;
+	if (request.method == "HEAD")
+		return true;
+
+	size_t limit = std::min(response.dropAfter, body.size());
+	if (response.chunkSize == 0) {
+		if (!connection.write(body.data(), limit))
+			return false;
+	} else {
+		for (size_t sent = 0; sent < limit; sent += response.chunkSize) {
+			if (sent != 0)
+				sleepMs(response.chunkDelayMs);
+			size_t length = std::min(response.chunkSize, limit - sent);
+			char size[32];
+			snprintf(size, sizeof(size), "%zx\r\n", length);
+			if (!connection.write(size) || !connection.write(body.data() + sent, length) || !connection.write("\r\n"))
+				return false;
+		}
+		if (limit == body.size() && !connection.write("0\r\n\r\n"))
+			return false;
+	}
+	//A cut off response can't be followed by another
+	return limit == body.size();
+}
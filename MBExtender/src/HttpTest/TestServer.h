@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+// TestServer.h
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <openssl/ssl.h>
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A scripted HTTP/1.1 server on the loopback interface, for testing the
+ * request code without real servers. Each path gets a canned response, which
+ * can be delayed, chunked, gzipped, cut off, or served in ranges. With TLS
+ * the server uses a self-signed certificate for localhost that is generated
+ * when the server starts.
+ */
+class TestServer {
+public:
+	struct Response {
+		int status = 200;
+		std::vector<std::pair<std::string, std::string>> headers;
+		std::string body;
+		//Wait this long before sending anything
+		int delayMs = 0;
+		//Send the body with chunked transfer encoding in pieces of this size,
+		// 0 to send it in one go with a Content-Length
+		size_t chunkSize = 0;
+		//Wait this long between chunks
+		int chunkDelayMs = 0;
+		//Gzip the body if the client accepts it
+		bool gzip = false;
+		//Answer "Range: bytes=N-" with a 206 and the rest of the body
+		bool ranges = false;
+		//Close the connection after this many body bytes
+		size_t dropAfter = SIZE_MAX;
+		//Send the request body back
+		bool echo = false;
+	};
+
+	//What the server got, for checking the headers a client sent
+	struct Request {
+		std::string method;
+		std::string path;
+		//Header names are lowercased
+		std::map<std::string, std::string> headers;
+		std::string body;
+	};
+
+	TestServer();
+	~TestServer();
+
+	/**
+	 * Start listening on a free loopback port.
+	 * @arg tls If the server should speak HTTPS.
+	 * @return If the server could be started.
+	 */
+	bool start(bool tls);
+
+	/**
+	 * Stop the server and wait for every connection to close.
+	 */
+	void stop();
+
+	/**
+	 * Set the response for a path. Paths without one get a 404.
+	 */
+	void route(const std::string &path, const Response &response);
+
+	/**
+	 * Get the last request made for a path.
+	 */
+	Request lastRequest(const std::string &path);
+
+	/**
+	 * @return The base URL of the server, like "https://localhost:1234".
+	 */
+	std::string getUrl() const;
+
+	/**
+	 * @return The self-signed certificate in PEM form, empty without TLS.
+	 */
+	const std::string &getCertificate() const { return mCertificate; }
+
+	/**
+	 * @return How many connections have been accepted.
+	 */
+	uint32_t getConnectionCount() const { return mConnections.load(); }
+
+private:
+	struct Connection;
+
+	bool createCertificate();
+	void acceptLoop();
+	void serve(int socket);
+	bool handleRequest(Connection &connection, const Request &request);
+
+	int mListenSocket = -1;
+	uint16_t mPort = 0;
+	bool mTls = false;
+	SSL_CTX *mSslContext = nullptr;
+	std::string mCertificate;
+
+	std::atomic<bool> mRunning;
+	std::atomic<uint32_t> mConnections;
+	std::thread mAcceptThread;
+	std::vector<std::thread> mConnectionThreads;
+
+	std::mutex mMutex;
+	std::map<std::string, Response> mRoutes;
+	std::map<std::string, Request> mRequests;
+};
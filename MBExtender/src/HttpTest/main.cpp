@@ -0,0 +1,388 @@
+//-----------------------------------------------------------------------------
+// main.cpp
+//
+// Copyright (c) 2026 The Platinum Team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+//Test harness for the HTTPObject request code. Starts a scripted HTTP and
+// HTTPS server on the loopback interface, runs requests against them with
+// the same curl options TLSSupport uses (see RequestOptions.h), checks the
+// results, and reports latency and throughput. Exits with 1 if any check
+// failed.
+
+#include "TestServer.h"
+#include "../../plugins/TLSSupport/RequestOptions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct Request {
+	std::string path;
+	std::string postBody;
+	bool post = false;
+	uint64_t resumeFrom = 0;
+	uint64_t maxSize = 0;
+	//Leave out the test certificate, so verification has to fail
+	bool untrusted = false;
+
+	//Filled in once the request is done
+	CURLcode code = CURLE_OK;
+	long status = 0;
+	std::string body;
+	double firstByteMs = 0;
+	double totalMs = 0;
+	long connects = 0;
+};
+
+static int gFailures = 0;
+
+static double getMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void check(bool condition, const std::string &scenario, const char *what) {
+	if (!condition) {
+		printf("  FAIL %s: %s\n", scenario.c_str(), what);
+		++gFailures;
+	}
+}
+
+static size_t writeCallback(char *buffer, size_t size, size_t nitems, Request *request) {
+	request->body.append(buffer, size * nitems);
+	return size * nitems;
+}
+
+/**
+ * Runs requests on one multi and share handle, like TLSSupport does, so
+ * connections and TLS sessions carry over between scenarios.
+ */
+class Driver {
+public:
+	Driver(const std::string &baseUrl, const std::string &caFile) : mBaseUrl(baseUrl), mCaFile(caFile) {
+		mHttp2 = (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) != 0;
+		mMulti = RequestOptions::createMulti(mHttp2);
+		mShare = RequestOptions::createShare();
+	}
+
+	~Driver() {
+		curl_multi_cleanup(mMulti);
+		curl_share_cleanup(mShare);
+	}
+
+	/**
+	 * Run requests at the same time and wait for all of them.
+	 * @return How long it took in milliseconds.
+	 */
+	double run(std::vector<Request> &requests) {
+		std::vector<CURL *> handles;
+		for (Request &request : requests) {
+			CURL *easy = curl_easy_init();
+			RequestOptions::applyDefaults(easy, mShare, mHttp2);
+			curl_easy_setopt(easy, CURLOPT_URL, (mBaseUrl + request.path).c_str());
+			curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeCallback);
+			curl_easy_setopt(easy, CURLOPT_WRITEDATA, &request);
+			curl_easy_setopt(easy, CURLOPT_PRIVATE, &request);
+			if (!mCaFile.empty() && !request.untrusted) {
+				curl_easy_setopt(easy, CURLOPT_CAINFO, mCaFile.c_str());
+			}
+			if (request.post) {
+				curl_easy_setopt(easy, CURLOPT_POST, 1L);
+				curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.postBody.size()));
+				curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.postBody.c_str());
+			}
+			if (request.resumeFrom != 0) {
+				RequestOptions::setResumeFrom(easy, request.resumeFrom);
+			}
+			RequestOptions::setMaxSize(easy, request.maxSize, request.resumeFrom);
+
+			curl_multi_add_handle(mMulti, easy);
+			handles.push_back(easy);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		int running = 1;
+		while (running > 0) {
+			curl_multi_perform(mMulti, &running);
+			int messages;
+			CURLMsg *message;
+			while ((message = curl_multi_info_read(mMulti, &messages)) != nullptr) {
+				if (message->msg != CURLMSG_DONE)
+					continue;
+				Request *request;
+				curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, reinterpret_cast<char **>(&request));
+				request->code = message->data.result;
+			}
+			if (running > 0) {
+				curl_multi_wait(mMulti, nullptr, 0, 100, nullptr);
+			}
+		}
+		double elapsed = getMs(start);
+
+		for (CURL *easy : handles) {
+			Request *request;
+			curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char **>(&request));
+			double firstByte = 0;
+			double total = 0;
+			curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &request->status);
+			curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &firstByte);
+			curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &total);
+			curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &request->connects);
+			request->firstByteMs = firstByte * 1000.0;
+			request->totalMs = total * 1000.0;
+
+			curl_multi_remove_handle(mMulti, easy);
+			curl_easy_cleanup(easy);
+		}
+		return elapsed;
+	}
+
+	/**
+	 * Run a single request.
+	 */
+	Request run(const Request &request) {
+		std::vector<Request> requests(1, request);
+		run(requests);
+		return requests[0];
+	}
+
+private:
+	std::string mBaseUrl;
+	std::string mCaFile;
+	bool mHttp2;
+	CURLM *mMulti;
+	CURLSH *mShare;
+};
+
+static Request get(const std::string &path) {
+	Request request;
+	request.path = path;
+	return request;
+}
+
+/**
+ * Body text that compresses like real responses do.
+ */
+static std::string makeBody(size_t length) {
+	std::string body;
+	body.reserve(length);
+	uint32_t seed = 1;
+	while (body.size() < length) {
+		seed = seed * 1103515245 + 12345;
+		body += "line " + std::to_string(body.size()) + " value " + std::to_string((seed >> 16) & 0x7fff) + "\n";
+	}
+	body.resize(length);
+	return body;
+}
+
+static void setupRoutes(TestServer &server, const std::string &file) {
+	TestServer::Response hello;
+	hello.body = "Hello, world!";
+	server.route("/hello", hello);
+
+	TestServer::Response gzip;
+	gzip.body = file;
+	gzip.gzip = true;
+	server.route("/gzip", gzip);
+
+	TestServer::Response chunked;
+	chunked.body = file;
+	chunked.chunkSize = 4096;
+	chunked.chunkDelayMs = 1;
+	server.route("/chunked", chunked);
+
+	TestServer::Response slow;
+	slow.body = "slow";
+	slow.delayMs = 200;
+	server.route("/slow", slow);
+
+	TestServer::Response error;
+	error.status = 503;
+	error.body = "Try again later";
+	server.route("/error", error);
+
+	TestServer::Response drop;
+	drop.body = file;
+	drop.dropAfter = file.size() / 2;
+	server.route("/drop", drop);
+
+	TestServer::Response redirect;
+	redirect.status = 302;
+	redirect.headers.push_back(std::make_pair("Location", "/hello"));
+	server.route("/redirect", redirect);
+
+	TestServer::Response ranged;
+	ranged.body = file;
+	ranged.ranges = true;
+	server.route("/file", ranged);
+
+	TestServer::Response echo;
+	echo.echo = true;
+	server.route("/echo", echo);
+}
+
+static void runScenarios(const char *scheme, TestServer &server, const std::string &caFile, const std::string &file) {
+	printf("%s (%s)\n", scheme, server.getUrl().c_str());
+	Driver driver(server.getUrl(), caFile);
+	std::string name;
+
+	name = std::string(scheme) + " basic";
+	Request hello = driver.run(get("/hello"));
+	check(hello.code == CURLE_OK && hello.status == 200, name, "request failed");
+	check(hello.body == "Hello, world!", name, "wrong body");
+	TestServer::Request sent = server.lastRequest("/hello");
+	check(sent.headers["user-agent"] == "Torque 1.0", name, "wrong user agent");
+	check(sent.headers["accept-encoding"].find("gzip") != std::string::npos, name, "gzip not accepted");
+	printf("  basic: %.1f ms, first byte %.1f ms\n", hello.totalMs, hello.firstByteMs);
+
+	name = std::string(scheme) + " reuse";
+	Request again = driver.run(get("/hello"));
+	check(again.code == CURLE_OK && again.connects == 0, name, "connection was not reused");
+	printf("  reused connection: %.1f ms\n", again.totalMs);
+
+	name = std::string(scheme) + " gzip";
+	Request gzip = driver.run(get("/gzip"));
+	check(gzip.code == CURLE_OK && gzip.body == file, name, "body was not decompressed");
+
+	name = std::string(scheme) + " chunked";
+	Request chunked = driver.run(get("/chunked"));
+	check(chunked.code == CURLE_OK && chunked.body == file, name, "chunked body differs");
+
+	name = std::string(scheme) + " delay";
+	Request slow = driver.run(get("/slow"));
+	check(slow.code == CURLE_OK && slow.firstByteMs >= 190, name, "response was not delayed");
+	printf("  delayed: first byte %.1f ms\n", slow.firstByteMs);
+
+	name = std::string(scheme) + " error status";
+	Request error = driver.run(get("/error"));
+	check(error.code == CURLE_OK && error.status == 503, name, "expected a 503");
+
+	name = std::string(scheme) + " dropped connection";
+	Request drop = driver.run(get("/drop"));
+	check(drop.code == CURLE_PARTIAL_FILE, name, "cut off transfer did not fail");
+
+	name = std::string(scheme) + " redirect";
+	Request redirect = driver.run(get("/redirect"));
+	check(redirect.code == CURLE_OK && redirect.status == 200 && redirect.body == "Hello, world!", name, "redirect not followed");
+
+	name = std::string(scheme) + " not found";
+	Request missing = driver.run(get("/missing"));
+	check(missing.code == CURLE_OK && missing.status == 404, name, "expected a 404");
+
+	name = std::string(scheme) + " resume";
+	Request resume = get("/file");
+	resume.resumeFrom = 1000;
+	resume = driver.run(resume);
+	check(resume.code == CURLE_OK && resume.status == 206, name, "expected a 206");
+	check(resume.body == file.substr(1000), name, "wrong part of the file");
+	check(server.lastRequest("/file").headers["range"] == "bytes=1000-", name, "wrong range");
+
+	name = std::string(scheme) + " max size";
+	Request tooLarge = get("/file");
+	tooLarge.maxSize = 1000;
+	tooLarge = driver.run(tooLarge);
+	check(tooLarge.code == CURLE_FILESIZE_EXCEEDED, name, "size limit not applied");
+
+	name = std::string(scheme) + " max size resumed";
+	Request fits = get("/file");
+	fits.resumeFrom = 1000;
+	fits.maxSize = file.size();
+	fits = driver.run(fits);
+	check(fits.code == CURLE_OK && fits.body == file.substr(1000), name, "resumed download hit the limit");
+
+	name = std::string(scheme) + " post";
+	Request post = get("/echo");
+	post.post = true;
+	post.postBody = "a=1&b=2";
+	post = driver.run(post);
+	check(post.code == CURLE_OK && post.body == "a=1&b=2", name, "body was not sent");
+
+	if (!caFile.empty()) {
+		name = std::string(scheme) + " untrusted certificate";
+		Request untrusted = get("/hello");
+		untrusted.untrusted = true;
+		untrusted = driver.run(untrusted);
+		check(untrusted.code != CURLE_OK, name, "self-signed certificate was accepted");
+	}
+
+	//Many requests at once, like a level loading its leaderboards
+	name = std::string(scheme) + " parallel";
+	std::vector<Request> parallel(24, get("/file"));
+	uint32_t before = server.getConnectionCount();
+	double elapsed = driver.run(parallel);
+	std::vector<double> latencies;
+	bool allOk = true;
+	for (const Request &request : parallel) {
+		allOk = allOk && request.code == CURLE_OK && request.body == file;
+		latencies.push_back(request.totalMs);
+	}
+	check(allOk, name, "a request failed");
+	//CURLMOPT_MAX_HOST_CONNECTIONS is 6
+	check(server.getConnectionCount() - before <= 6, name, "too many connections");
+	std::sort(latencies.begin(), latencies.end());
+	double megabytes = static_cast<double>(file.size()) * parallel.size() / (1024.0 * 1024.0);
+	printf("  parallel: %u requests, %u new connections, p50 %.1f ms, p95 %.1f ms, max %.1f ms, %.1f MiB/s\n",
+		static_cast<uint32_t>(parallel.size()), server.getConnectionCount() - before,
+		latencies[latencies.size() / 2], latencies[latencies.size() * 95 / 100], latencies.back(),
+		megabytes / (elapsed / 1000.0));
+}
+
+int main(int argc, const char **argv) {
+	curl_global_init(CURL_GLOBAL_ALL);
+	std::string file = makeBody(256 * 1024);
+
+	TestServer http;
+	TestServer https;
+	if (!http.start(false) || !https.start(true)) {
+		fprintf(stderr, "Could not start the test servers\n");
+		return 1;
+	}
+	setupRoutes(http, file);
+	setupRoutes(https, file);
+
+	//curl only takes a CA file by path
+	char caFile[] = "/tmp/HttpTest-XXXXXX";
+	int fd = mkstemp(caFile);
+	if (fd < 0 || write(fd, https.getCertificate().data(), https.getCertificate().size()) < 0) {
+		fprintf(stderr, "Could not write the test certificate\n");
+		return 1;
+	}
+	close(fd);
+
+	runScenarios("http", http, "", file);
+	runScenarios("https", https, caFile, file);
+
+	unlink(caFile);
+	http.stop();
+	https.stop();
+	curl_global_cleanup();
+
+	if (gFailures != 0) {
+		printf("%d checks failed\n", gFailures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -35,6 +35,10 @@ const char *Plugin::getPath() const {
     return plugin_->path;
 }
 
+MBX_CpuFeatures Plugin::getCpuFeatures() const {
+    return plugin_->cpuFeatures;
+}
+
 CodeStream &Plugin::getCodeStream() {
     return codeStream_;
 }
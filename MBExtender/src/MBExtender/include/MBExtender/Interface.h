@@ -54,6 +54,8 @@ typedef enum MBX_CpuFeatures {
     MBX_CPU_NONE = 0,
     MBX_CPU_3DNOW = 1 << 0,
     MBX_CPU_SSE = 1 << 1,
+    MBX_CPU_SSE2 = 1 << 2,
+    MBX_CPU_SSSE3 = 1 << 3,
 } MBX_CpuFeatures;
 
 struct MBX_PluginOperations;
@@ -58,6 +58,11 @@ class Plugin {
     /// </returns>
     const char *getPath() const;
 
+    /// <summary>
+    /// Get the CPU feature flags detected by the plugin loader.
+    /// </summary>
+    MBX_CpuFeatures getCpuFeatures() const;
+
     /// <summary>
     /// Get a stream which can be used to manually edit code.
     /// </summary>
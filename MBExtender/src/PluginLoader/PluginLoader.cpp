@@ -69,6 +69,8 @@
 #endif
 
 constexpr unsigned int CpuidFlagSse = (1 << 25);
+constexpr unsigned int CpuidFlagSse2 = (1 << 26);
+constexpr unsigned int CpuidFlagSsse3 = (1 << 9);
 constexpr unsigned int CpuidFlag3dnow = (1 << 31);
 constexpr unsigned int CpuidFlag3dnowPrefetch = (1 << 8);
 
@@ -120,6 +122,12 @@ MBX_CpuFeatures detectCpuFeatures() {
     if (edx & CpuidFlagSse) {
         features |= MBX_CPU_SSE;
     }
+    if (edx & CpuidFlagSse2) {
+        features |= MBX_CPU_SSE2;
+    }
+    if (ecx & CpuidFlagSsse3) {
+        features |= MBX_CPU_SSSE3;
+    }
 
     // Detect 3DNow support
     // Support for the prefetch instruction is also necessary
@@ -43,36 +43,52 @@
 
 namespace {
 // Fix FindMatch::isMatch to not go past the end of the string if the expression ends with *
+// This is also iterative instead of recursive. The original backtracks through every '*' at once, which takes
+// exponential time for patterns like "*a*a*a*b". Only the most recent '*' ever needs to be retried: once a later '*'
+// has matched, it can absorb anything that an earlier '*' would have skipped.
+// The quirks of the original are kept: the character after a '*' is found with strchr, so it is always matched
+// literally and case-sensitively (even '*' and '?'), and a '*' only matches an empty string if it is the last thing in
+// the expression and there is still unmatched input when it is reached.
 bool (*originalIsMatch)(const char *exp, const char *str, bool caseSensitive);
 bool FindMatch_isMatch(const char *exp, const char *str, bool caseSensitive) {
-    auto match = true;
-    while (match && *exp && *str) {
-        switch (*exp) {
-            case '*':
+    const char *starExp = nullptr;  // Expression right after the last '*'
+    const char *starStr = nullptr;  // Where the last '*' stopped matching
+    while (true) {
+        if (*exp && *str) {
+            if (*exp == '*') {
                 exp++;
-                match = false;
-                while (!match &&
-                       (str = strchr(str, *exp)) != nullptr)  // Original function calls strchr before checking match
-                {
-                    match = FindMatch_isMatch(exp, str, caseSensitive);
-                    str++;
-                }
-                return match;
-            case '?':
-                exp++;
-                str++;
-                break;
-            default:
+                str = strchr(str, *exp);  // Original function calls strchr before checking match
+                if (str == nullptr)
+                    return false;
+                starExp = exp;
+                starStr = str;
+                continue;
+            }
+            auto match = (*exp == '?');
+            if (!match) {
                 if (caseSensitive)
-                    match = (*exp++ == *str++);
+                    match = (*exp == *str);
                 else
-                    match = (toupper(*exp++) == toupper(*str++));
-                break;
+                    match = (toupper(*exp) == toupper(*str));
+            }
+            if (match) {
+                exp++;
+                str++;
+                continue;
+            }
+        } else if (*exp == *str) {
+            return true;
         }
+
+        // Mismatch, let the last '*' match one more occurrence of the character after it
+        if (starExp == nullptr || *starStr == '\0')
+            return false;
+        starStr = strchr(starStr + 1, *starExp);
+        if (starStr == nullptr)
+            return false;
+        exp = starExp;
+        str = starStr;
     }
-    if (*exp != *str)
-        match = false;
-    return match;
 }
 
 // Fix GuiMLTextCtrl::allocBitmap to copy the bitmap name to a buffer